@@ -0,0 +1,55 @@
+/// \file TntBeamProfile.hh
+/// \brief Definition of the TntBeamProfile class
+///
+#ifndef TntBeamProfile_h
+#define TntBeamProfile_h 1
+
+#include <map>
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+/// Starting position and direction of the primaries of the standard generator
+/** One implementation per 'beamtype' ("pencil", "rectangle", "scan",
+ *  "diffuse", "conic", "acceptance"), chosen once by TntPrimaryGeneratorAction. Profiles
+ *  register a factory under their 'beamtype' name with Register(), from a
+ *  static object in their own source file, so that new profiles need no
+ *  change to the generator. Everything that does not change from event to
+ *  event is computed in the constructor.
+ */
+class TntBeamProfile
+{
+public:
+	typedef TntBeamProfile* (*Factory)();
+
+	/// Source z: 'beamz' cm upstream of the front of the detector ('dz')
+	TntBeamProfile();
+	virtual ~TntBeamProfile();
+
+	/// Position and direction of the next primary
+	virtual void Generate(G4ThreeVector& position, G4ThreeVector& direction) = 0;
+
+	/// ID of the event being generated, set by the generator before Generate()
+	void SetEventID(G4int eventID) { fEventID = eventID; }
+
+	/// Weight of the last primary: 1, except for importance-sampled profiles
+	G4double GetWeight() const { return fWeight; }
+
+	G4double GetBeamZ() const { return fBeamZ; }
+	/// Source z from the current 'beamz' and 'dz'
+	static G4double ComputeBeamZ();
+
+	/// Make \a factory create the profile for 'beamtype \a name'
+	static G4bool Register(const G4String& name, Factory factory);
+	/// New profile for 'beamtype \a name', or NULL if there is none
+	static TntBeamProfile* Create(const G4String& name);
+
+protected:
+	G4double fBeamZ;
+	G4int fEventID;
+	G4double fWeight;
+
+private:
+	static std::map<G4String, Factory>& GetRegistry();
+};
+
+#endif
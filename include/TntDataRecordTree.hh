@@ -16,6 +16,7 @@
 #ifndef DATARECORD_H
 #define DATARECORD_H
 
+#include <cmath>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -52,6 +53,7 @@ public:
 	struct Hit_t { 
 		G4double X, Y, Z, T, E;
 		G4int TrackID, ParentTrackID, Type;
+		G4double W; // track weight
 		bool operator== (const Hit_t& rhs) {
 			if(rhs.X == X && rhs.Y == Y && rhs.Z == Z && 
 				 rhs.T == T && rhs.E == E && 
@@ -64,6 +66,19 @@ public:
 			return !(this->operator==(rhs));
 		}
 };
+
+	/// Weighted count: entries, sum of weights and of squared weights
+	/** With weights w_i of an unbiased scheme, w estimates the analog count
+	 *  and sqrt(w2) its statistical error.
+	 */
+	struct Tally_t {
+		G4int n;
+		G4double w, w2;
+		Tally_t(): n(0), w(0), w2(0) { }
+		void Add(G4double weight) { ++n; w += weight; w2 += weight*weight; }
+		void Clear() { n = 0; w = w2 = 0; }
+		G4double Error() const { return sqrt(w2); }
+	};
 	
 private:
 
@@ -86,6 +101,9 @@ private:
   G4int eng_Tnt_PhotonBack;
 //by Shuya 160502
   G4int eng_Tnt_PhotonTotal;
+  // Detected photons summed with their track weights (see TntPMTHit)
+  G4double eng_Tnt_PhotonFrontWeighted;
+  G4double eng_Tnt_PhotonBackWeighted;
 //by Shuya 160502
   G4double edep_Tnt;
   G4double edep_Tnt_proton;
@@ -108,6 +126,8 @@ private:
 	/// GAC
 	std::vector<G4int> PhotonSum; // Sum of all photons incident on a PMT
 	std::vector<G4int> PhotonSumFront;
+	std::vector<G4double> PhotonWeightSum; // Same, summed with photon weights
+	std::vector<G4double> PhotonWeightSumFront;
 	TH2I* hDigi; // Histogram of digitized time signals for each PMT
 	///
 	/// Vectors of all hit information
@@ -118,7 +138,9 @@ private:
 	std::vector<G4double> HitT;
 	std::vector<G4double> HitE;
 	std::vector<G4int>    HitTrackID;
+	std::vector<G4int>    HitPrimary; // primary each hit descends from (index in PrimaryMomenta)
 	std::vector<G4int>    HitType;
+	std::vector<G4double> HitW;       // track weight of each hit
 	TClonesArray* fHits;
 	TClonesArray* fHit01;
 	Int_t iHit0, iHit1;
@@ -129,6 +151,8 @@ private:
 	std::vector<G4double> fMenateHitsE;	
 	std::vector<G4int> fMenateHitsType;
 	std::vector<G4int> fMenateHitsDetector;
+	std::vector<G4int> fMenateHitsPrimary;
+	std::vector<G4double> fMenateHitsWeight;
 	
 	///
 	/// Positions of original fired neutron
@@ -136,6 +160,8 @@ private:
 	G4double PrimaryY;
 	G4double PrimaryZ;
 	TLorentzVector* PrimaryMomentum;
+	TClonesArray* fPrimaries;    // momenta of all primaries of the event, in vertex order
+	G4double fPrimaryEnergy;     // kinetic energy of the primary being generated
 	TLorentzVector* SecondaryMomentum; // recoil momentum if neutron decay
 	TLorentzVector* EjectileMomentum;  // ejectile from population reaction [e.g. (d,3He)]
 	TLorentzVector* BeamMomentum;      // beam from population reaction
@@ -161,23 +187,47 @@ private:
   // Particle Counters
 
   int event_counter;
-  int number_total;
-  int number_protons;
-  int number_alphas;
-  int number_C12;
-  int number_EG;
-  int number_Exotic;
+  Tally_t number_events;  // all events filled
+  Tally_t number_total;
+  Tally_t number_protons;
+  Tally_t number_alphas;
+  Tally_t number_C12;
+  Tally_t number_EG;
+  Tally_t number_Exotic;
 //by Shuya 160407
-  int number_Photon;
+  Tally_t number_Photon;
 
   // Efficiency Calculators
-  int number_at_this_energy;
+  Tally_t number_at_this_energy;  // events above threshold
   double efficiency;
 
+  // Event weight (source acceptance, forced interaction in menate_R), 1 for
+  // analog events
+  G4double EventWeight;
+  // Acceptance weight of the primary ('beamtype acceptance'), 1 otherwise
+  G4double EventAcceptance;
+
+  // Run totals of optical photons tracked and killed by the cutoffs of
+  // TntSteppingAction (time, reflections, path length)
+  long photons_tracked;
+  long photons_cut[3];
+
+  // Run totals of WLS photons trapped by TntWLSFiberModel and of photons
+  // reaching the fiber ends (with the sum of their arrival times, ns)
+  long fiber_captured;
+  long fiber_ends;
+  double fiber_end_time;
+
+	// RNG seed of the job
+	std::string fRngSeed;
+
 	// INPUT PARAMETERS //
 	G4int npmtX, npmtY;
 	G4double eNeut;
 	G4double detector_x, detector_y, detector_z;
+	// Geometry configuration of the events (geometry sweep), 0 for the
+	// geometry of the input file
+	G4int fGeometry;
 
   
  public:
@@ -208,6 +258,7 @@ private:
   //void senddataPMT(int id, double value1);
 //by Shuya 160421
 	void senddataPMT_Time(int id, G4double time);
+	void senddataPMT_Weighted(int id, G4double value1);
   void senddataPMT(int id, int value1, int evid);
   void createdataPMT(int evid);
 
@@ -222,18 +273,45 @@ private:
   void senddataPosition(const G4ThreeVector& pos);
 	void senddataHits(const std::vector<Hit_t>& hit, bool sortTime);
   void senddataTOF(G4double time);
-	void senddataMenateR(G4double ekin, const G4ThreeVector& posn, G4int copyNo, G4double t, G4int type);
+	/// Multiply the weight of the current event by \a factor (reset to 1
+	/// after each FillTree()); the forced interactions of the primaries of an
+	/// event ('neutrons_per_event all') combine as a product
+	void senddataWeightFactor(G4double factor);
+	/// Acceptance weight of the primary of the current event, also the event
+	/// weight that the menate_R forcing factors multiply
+	void senddataAcceptance(G4double weight);
+	/// Tag the following events with geometry configuration \a index, and
+	/// add a tInput entry with its parameters
+	void senddataGeometry(G4int index);
+	/// Add the optical photons tracked in an event, and those killed by the
+	/// time, reflection and path-length cutoffs, to the run totals
+	void senddataPhotonCuts(G4int tracked, G4int cutTime, G4int cutReflections, G4int cutPath);
+	/// Add the WLS photons trapped in the fibers and those reaching the fiber
+	/// ends in an event (sum of arrival times in G4 units) to the run totals
+	void senddataFiber(G4int captured, G4int ends, G4double endTime);
+	void senddataMenateR(G4double ekin, const G4ThreeVector& posn, G4int copyNo, G4double t, G4int type,
+											 G4int trackID, G4double weight);
   void ShowDataFromEvent();
   void FillTree();
 //by Shuya 160422.
   void FillTree2(int evid);
   void GetParticleTotals();
   void CalculateEff(int ch_eng);
+	/// Number of events above Det_Threshold since the last reset
+	int GetNumberAtThisEnergy() const { return number_at_this_energy.n; }
+	/// Sum of weights of the events above Det_Threshold
+	double GetWeightAtThisEnergy() const { return number_at_this_energy.w; }
+	void ResetNumberAtThisEnergy() { number_at_this_energy.Clear(); }
+	/// Efficiency (weighted fraction of \a nevents above Det_Threshold since
+	/// the last reset) and its error: binomial for unit weights, else
+	/// sqrt((w2/N - eff^2)/N)
+	void GetEfficiency(int nevents, double& eff, double& err) const;
 
-	G4int GetParticleCode(const G4String& name);
-	G4int GetReactionCode(const G4String& name);
-	G4String GetParticleName(G4int  code);
-	G4String GetReactionName(G4int  code);	
+	// Code tables are static, usable without (or after deleting) TntPointer
+	static G4int GetParticleCode(const G4String& name);
+	static G4int GetReactionCode(const G4String& name);
+	static G4String GetParticleName(G4int  code);
+	static G4String GetReactionName(G4int  code);	
 
 	/// Save central positions of each detector, if an array
 	/** Positions are saved in a separate TTree, 'detpos'. The
@@ -257,5 +335,7 @@ private:
 	
 private:
   TntDataRecordTree() {;}   // Hide Default Constructor
+	/// Primary \a trackID descends from (TntUserEventInformation), -1 if unknown
+	G4int GetPrimaryOfTrack(G4int trackID) const;
 }; 
 #endif
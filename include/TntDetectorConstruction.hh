@@ -38,6 +38,13 @@ class G4Box;
 class G4Tubs;
 class TntMainVolume;
 class G4Sphere;
+class G4Region;
+class TntLightMap;
+class TntLightMapModel;
+class TntRayTracer;
+class TntRayTraceModel;
+class TntWLSSlab;
+class TntWLSFiberModel;
 
 #include <vector>
 
@@ -74,6 +81,11 @@ class TntDetectorConstruction : public G4VUserDetectorConstruction
     void SetPMTSizeY(G4double );
     void SetDefaults();
 
+    //Stage geometry changes: the setters called between BeginUpdate() and
+    //the matching EndUpdate() cause a single rebuild (updates may nest)
+    void BeginUpdate();
+    void EndUpdate();
+
     //Get values
     G4int GetNX(){return fNx;}
     G4int GetNY(){return fNy;}
@@ -87,6 +99,8 @@ class TntDetectorConstruction : public G4VUserDetectorConstruction
     G4double GetPMTSizeX(){return fPmt_x;}
     G4double GetPMTSizeY(){return fPmt_y;}
     G4double GetSlabZ(){return fSlab_z;}
+    //Number of PMTs on each scintillator (all six faces of a box)
+    G4int GetNumPMTs(){return (fNx*fNy+fNx*fNz+fNy*fNz)*2;}
  
     void SetSphereOn(G4bool );
     static G4bool GetSphereOn(){return fSphereOn;}
@@ -106,14 +120,39 @@ class TntDetectorConstruction : public G4VUserDetectorConstruction
     void SetMainScintYield(G4double );
     void SetWLSScintYield(G4double );
 
-  	void GetDetectorOffset(G4int i, G4double& x, G4double& y);
+  	void GetDetectorOffset(G4int i, G4double& x, G4double& y) const;
+    //Number of placed scintillators, and the radius of a sphere around the
+    //housing of one of them (centred on the scintillator)
+    G4int GetNumDetectors() const {return fOffsetX.empty() ? 1 : G4int(fOffsetX.size());}
+    G4double GetDetectorRadius() const;
+
+    //Light-collection map used by TntLightMapModel, or being filled by the
+    //'lightmap_mode build' calibration run (NULL if none)
+    TntLightMap* GetLightMap() const {return fLightMap;}
+    //Parameters the light map depends on, and the map file for them
+    G4String GetLightMapGeometry();
+    G4String GetLightMapFileName();
+
+    //Analytic optical transport used by TntRayTraceModel (NULL if none)
+    const TntRayTracer* GetRayTracer() const {return fRayTracer;}
+    //This thread's TntRayTraceModel (NULL if none)
+    TntRayTraceModel* GetRayTraceModel() const {return fRayTraceModel.Get();}
 	
   private:
     void ConstructSDandField1();
 	  void ConstructSDandFieldN();
+	  void SetupLightMap();
+	  void SetupRayTracer();
+	  void SetupScintRegion();
+	  void SetupFiberRegion(TntWLSSlab* slab);
+	  void ConstructLightMapModel();
+	  void ConstructRayTraceModel();
+	  void ConstructWLSFiberModel();
 
 	  void DefineMaterials();
     G4VPhysicalVolume* ConstructDetector();
+    //Rebuild the geometry, or mark it for rebuilding inside an update
+    void GeometryChanged();
 
     TntDetectorMessenger* fDetectorMessenger;
 
@@ -167,6 +206,24 @@ class TntDetectorConstruction : public G4VUserDetectorConstruction
     G4Cache<TntScintSD*> fScint_SD;
     G4Cache<TntPMTSD*> fPmt_SD;
 
+    //Light map fast simulation
+    TntLightMap* fLightMap;
+    G4String fLightMapFile; //file fLightMap was read from
+    G4Region* fScintRegion;
+    G4Cache<TntLightMapModel*> fLightMapModel;
+
+    //Analytic optical transport
+    TntRayTracer* fRayTracer;
+    G4Cache<TntRayTraceModel*> fRayTraceModel;
+
+    //Parametrized WLS fiber transport
+    G4Region* fFiberRegion;
+    G4Cache<TntWLSFiberModel*> fWLSFiberModel;
+
+    //Geometry update nesting, and whether the geometry changed inside it
+    G4int fUpdateDepth;
+    G4bool fUpdatePending;
+
 //by Shuya 160407
   G4String Light_Conv_Method;
 
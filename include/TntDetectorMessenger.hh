@@ -70,6 +70,8 @@ class TntDetectorMessenger: public G4UImessenger
     G4UIcmdWithABool*            fLxeCmd;
     G4UIcmdWithAnInteger*        fNFibersCmd;
     G4UIcommand*                 fDefaultsCmd;
+    G4UIcommand*                 fBeginUpdateCmd;
+    G4UIcommand*                 fEndUpdateCmd;
     G4UIcmdWithADouble*          fMainScintYield;
     G4UIcmdWithADouble*          fWLSScintYield;
 };
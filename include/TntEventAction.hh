@@ -66,6 +66,16 @@ class TntEventAction : public G4UserEventAction
 
   private:
 
+    //Compare the PMT hits of a fully tracked event with the light map
+    //expectation ("lightmap_mode validate") or the analytic ray-tracing
+    //expectation ("optical_transport validate")
+    void ValidateLightMap(const G4Event*);
+    void PrintLightMapValidation();
+    //Store the PMT hits of a 'lightmap_mode build' event in the light map
+    void FillLightMap(const G4Event*);
+    //Mean detected photons per event with a QE curve ('qe_file')
+    void PrintQESummary();
+
     TntRecorderBase* fRecorder;
     TntEventMessenger* fEventMessenger;
 
@@ -86,6 +96,19 @@ class TntEventAction : public G4UserEventAction
 //by Shuya 160408
     TntDataRecordTree* TntDataOutEV;
 
+    //Light map validation totals
+    G4int    fLightMapEvents;
+    G4double fLightMapExpected;
+    G4double fLightMapObserved;
+    G4double fLightMapChi2;
+    G4int    fLightMapNdf;
+
+    //Detected photons per event with a QE curve, to compare 'qe_mode'
+    //birth and boundary runs
+    G4int    fQEEvents;
+    G4double fQEHits;
+    G4double fQEHits2;
+
 };
 
 #endif
@@ -3,8 +3,12 @@
 ///
 #ifndef TNT_GLOBAL_PARAMS_
 #define TNT_GLOBAL_PARAMS_
+#include <map>
+#include <vector>
 #include "globals.hh"
 
+class TntQECurve;
+
 class TntGlobalParams {
 public:
 	static TntGlobalParams* Instance();
@@ -24,6 +28,24 @@ public:
 	G4String GetReacFile() const { return fReacFile; }
 	void SetReacFile(G4String type) { fReacFile = type; }
 
+	/// File of pre-generated primaries to read (TntPGAStream), "" = none
+	G4String GetPrimariesIn() const { return fPrimariesIn; }
+	void SetPrimariesIn(G4String file) { fPrimariesIn = file; }
+	/// File recording the primaries of the reaction generators, "" = none
+	G4String GetPrimariesOut() const { return fPrimariesOut; }
+	void SetPrimariesOut(G4String file) { fPrimariesOut = file; }
+
+	/// Neutrons of a multi-neutron reaction shot per event: "one" (default),
+	/// each neutron in its own event; "all", every neutron in one event
+	G4String GetNeutronsPerEvent() const { return fNeutronsPerEvent; }
+	void SetNeutronsPerEvent(G4String mode);
+	G4bool GetAllNeutronsInEvent() const { return fNeutronsPerEvent == "all"; }
+
+	/// Reactions pre-sampled per batch on a helper thread by the reaction
+	/// generators (TntReactionSampler), 0 (default) = sample in the event loop
+	G4int GetPrimariesBatch() const { return fPrimariesBatch; }
+	void SetPrimariesBatch(G4int n);
+
 	G4String GetInputFile() const { return fInputFile; }
 	void SetInputFile(G4String type) { fInputFile = type; }
 
@@ -36,6 +58,111 @@ public:
 	G4int GetMenateR_Tracking();
 	void SetMenateR_Tracking(G4int n);
 
+	/// "table" (default): inverse-CDF tables for the menate_R angular and
+	/// evaporation samplers; "analytic": original rejection/iterative samplers
+	G4String GetMenateR_Sampler() const { return fMenateR_Sampler; }
+	void SetMenateR_Sampler(G4String sampler);
+
+	/// Force the first MENATE_R interaction of each primary neutron, weighting
+	/// the event by the interaction probability along its line (variance reduction)
+	G4bool GetMenateR_Force() const { return fMenateR_Force; }
+	void SetMenateR_Force(G4bool on) { fMenateR_Force = on; }
+
+	/// Time menate_R::PostStepDoIt per reaction channel, printed at the end of the job
+	G4bool GetMenateR_Benchmark() const { return fMenateR_Benchmark; }
+	void SetMenateR_Benchmark(G4bool on) { fMenateR_Benchmark = on; }
+
+	/// Number of samples per point for the menate_R table validation (0 = off)
+	G4int GetMenateR_Validate() const { return fMenateR_Validate; }
+	void SetMenateR_Validate(G4int n) { fMenateR_Validate = n; }
+
+	/// Optical photon simulation (default on); when off, G4OpticalPhysics, the
+	/// optical material/surface properties and the PMT SDs are not built, and
+	/// only the analytic light output of TntScintSD is recorded
+	G4bool GetOpticalPhysics() const { return fOpticalPhysics; }
+	void SetOpticalPhysics(G4bool on) { fOpticalPhysics = on; }
+
+	/// Light (MeVee, unsmeared) the scintillator hits of an event must reach
+	/// before its optical photons are tracked; < 0 (default) = always track
+	/** See TntStackingAction */
+	G4double GetPhotonThreshold() const { return fPhotonThreshold; }
+	void SetPhotonThreshold(G4double light) { fPhotonThreshold = light; }
+
+	/// Fraction of the scintillation/Cerenkov photons kept (Russian roulette in
+	/// TntStackingAction, survivors get weight 1/f); 1 (default) = keep all
+	G4double GetPhotonFraction() const { return fPhotonFraction; }
+	void SetPhotonFraction(G4double f);
+
+	/// Optical photon cutoffs applied in TntSteppingAction; < 0 (default) = off
+	/** Time cut: end of the readout window plus a margin (ns) */
+	G4double GetPhotonTimeCut() const
+		{ return fPhotonWindow < 0 ? -1 : fPhotonWindow + fPhotonWindowMargin; }
+	void SetPhotonWindow(G4double end, G4double margin)
+		{ fPhotonWindow = end; fPhotonWindowMargin = margin; }
+	/// Maximum number of reflections of an optical photon
+	G4int GetPhotonMaxReflections() const { return fPhotonMaxReflections; }
+	void SetPhotonMaxReflections(G4int n) { fPhotonMaxReflections = n; }
+	/// Maximum path length of an optical photon (mm)
+	G4double GetPhotonMaxPath() const { return fPhotonMaxPath; }
+	void SetPhotonMaxPath(G4double length) { fPhotonMaxPath = length; }
+
+	/// Light-collection map replacing optical photon tracking in the scintillator
+	/// (see TntLightMap); empty = track all photons, "auto" = the map built for
+	/// this geometry in GetLightMapDir()
+	G4String GetLightMapFile() const { return fLightMapFile; }
+	void SetLightMapFile(G4String file) { fLightMapFile = file; }
+
+	/// "fast" (default): sample PMT hits from the light map; "full": track photons
+	/// and ignore the map; "validate": track photons and compare with the map;
+	/// "build": calibration run writing the map, no other output
+	G4String GetLightMapMode() const { return fLightMapMode; }
+	void SetLightMapMode(G4String mode);
+	/// True if the light-map fast-simulation model should be built
+	G4bool GetUseLightMap() const
+		{ return fOpticalPhysics && !fLightMapFile.empty() &&
+				fLightMapMode != "full" && fLightMapMode != "build"; }
+	G4bool GetLightMapBuild() const { return fLightMapMode == "build"; }
+
+	/// Optical photon transport in the scintillator: "geant4" (default),
+	/// "analytic" (TntRayTracer, box and cylinder cells) or "validate" (track
+	/// with Geant4 and compare with the analytic expectation)
+	G4String GetOpticalTransport() const { return fOpticalTransport; }
+	void SetOpticalTransport(G4String mode);
+	/// True if the analytic ray-tracing model should be built
+	G4bool GetUseRayTracing() const
+		{ return fOpticalPhysics && fOpticalTransport != "geant4"; }
+	/// Photons traced together by the analytic transport (up to 16);
+	/// 0 or 1 (default) = one at a time
+	G4int GetOpticalPacket() const { return fOpticalPacket; }
+	void SetOpticalPacket(G4int n);
+
+	/// Transport of the WLS photons in the fibers of the WLS slab: "geant4"
+	/// (default) or "param" (TntWLSFiberModel, trapped photons are moved to
+	/// the fiber end without tracking)
+	G4String GetWLSTransport() const { return fWLSTransport; }
+	void SetWLSTransport(G4String mode);
+	/// True if the parametrized fiber transport should be built
+	G4bool GetUseWLSParam() const
+		{ return fOpticalPhysics && fWLSTransport == "param"; }
+
+	/// Directory holding the maps found with 'lightmap auto'
+	G4String GetLightMapDir() const { return fLightMapDir; }
+	void SetLightMapDir(G4String dir) { fLightMapDir = dir; }
+
+	/// Voxels of a map built with 'lightmap_mode build'
+	void SetLightMapGrid(G4int nvx, G4int nvy, G4int nvz)
+		{ fLightMapGrid[0] = nvx; fLightMapGrid[1] = nvy; fLightMapGrid[2] = nvz; }
+	void GetLightMapGrid(G4int& nvx, G4int& nvy, G4int& nvz) const
+		{ nvx = fLightMapGrid[0]; nvy = fLightMapGrid[1]; nvz = fLightMapGrid[2]; }
+
+	/// Photons launched per voxel when building a map
+	G4int GetLightMapPhotons() const { return fLightMapPhotons; }
+	void SetLightMapPhotons(G4int n) { fLightMapPhotons = n; }
+
+	/// Worker threads used when building a map
+	G4int GetLightMapThreads() const { return fLightMapThreads; }
+	void SetLightMapThreads(G4int n) { fLightMapThreads = n; }
+
 	G4String GetScintMaterial() const { return fScintMaterial; }
 	void SetScintMaterial(G4String materialName) { fScintMaterial = materialName; }
 
@@ -57,6 +184,22 @@ public:
 	G4double GetQuantumEfficiency() const { return fQuantumEfficiency; }
 	void SetQuantumEfficiency(G4double e) { fQuantumEfficiency = e; }
 
+	/// Wavelength-dependent QE read from a file (see TntQECurve), replacing
+	/// the constant 'qe'; NULL if none was given
+	const TntQECurve* GetQECurve() const { return fQECurve; }
+	void SetQEFile(G4String file);
+	G4String GetQEFile() const { return fQEFile; }
+
+	/// Where the QE curve is applied: "birth" (default): photons are kept with
+	/// probability QE(lambda) when created (TntStackingAction); "boundary":
+	/// photocathode EFFICIENCY, all photons tracked (to validate "birth")
+	G4String GetQEMode() const { return fQEMode; }
+	void SetQEMode(G4String mode);
+
+	/// Scintillation photons per MeV of the main scintillator: the light
+	/// output, times the constant QE unless a QE curve is used
+	G4double GetScintillationYield() const;
+
 	G4String GetAngerAnalysis() const { return fAngerAnalysis; }
 	void SetAngerAnalysis(G4String name) { fAngerAnalysis = name; }
 
@@ -70,6 +213,91 @@ public:
 		{ fNdetX = nx; fNdetY = ny; }
 	void GetNumDetXY(G4int& nx, G4int& ny)
 		{ nx=fNdetX; ny=fNdetY; }
+
+	/// Select the cross-section file used by menate_R for one channel
+	/** \param [in] channel Reaction name, as in TntDataRecordTree::GetReactionCode()
+	 *  (e.g. "N_P_elastic", "N_C12_elastic", ...)
+	 *  \param [in] file File name, relative to the MENATEG4 directory unless it
+	 *  starts with '/' (e.g. "other_files/Carbon_12_MCNPx.dat")
+	 */
+	void SetXSFile(G4String channel, G4String file);
+	/// Return the file selected for \a channel, or \a defaultFile if none was selected
+	G4String GetXSFile(const G4String& channel, const G4String& defaultFile) const;
+	const std::map<G4String, G4String>& GetXSFiles() const { return fXSFiles; }
+	void SetXSFiles(const std::map<G4String, G4String>& files);
+	/// Incremented each time the cross-section selection changes; menate_R
+	/// reloads its tables when this differs from the version it last loaded.
+	G4int GetXSVersion() const { return fXSVersion; }
+
+	/// Add a channel override to the comparison library called \a label
+	/** Each library is run in turn on top of the 'xsfile' selection, which
+	 *  is always run first under the label "default".
+	 */
+	void AddXSCompare(G4String label, G4String channel, G4String file);
+	const std::vector<G4String>& GetXSCompareLabels() const { return fXSCompareLabels; }
+	std::map<G4String, G4String> GetXSCompareFiles(const G4String& label) const;
+
+	/// Neutron energies (MeV) swept in cross-section comparison mode
+	void SetXSCompareEnergy(G4double emin, G4double emax, G4double step);
+	const std::vector<G4double>& GetXSCompareEnergies() const { return fXSCompareEnergies; }
+
+	G4int GetXSCompareEvents() const { return fXSCompareEvents; }
+	void SetXSCompareEvents(G4int n) { fXSCompareEvents = n; }
+
+	/// Neutron energies (MeV) of the energy sweep, one run each
+	void SetSweepEnergies(std::vector<G4double> energies);
+	/// Same, from \a emin to \a emax in steps of \a step (MeV)
+	void SetEnergySweep(G4double emin, G4double emax, G4double step);
+	const std::vector<G4double>& GetSweepEnergies() const { return fSweepEnergies; }
+
+	/// Events per energy of the energy sweep
+	G4int GetSweepEvents() const { return fSweepEvents; }
+	void SetSweepEvents(G4int n);
+
+	/// Grid of 'beamtype scan' along x, y, z (cm): min, min+step, ... <= max
+	void SetScanX(G4double min, G4double max, G4double step) { SetScanAxis(0, min, max, step); }
+	void SetScanY(G4double min, G4double max, G4double step) { SetScanAxis(1, min, max, step); }
+	void SetScanZ(G4double min, G4double max, G4double step) { SetScanAxis(2, min, max, step); }
+	void SetScanAxis(G4int axis, G4double min, G4double max, G4double step);
+	/// First point (G4 units), spacing and number of points along \a axis
+	void GetScanAxis(G4int axis, G4double& min, G4double& step, G4int& n) const
+		{ min = fScanMin[axis]; step = fScanStep[axis]; n = fScanPoints[axis]; }
+
+	/// Events shot at each point of the scan
+	G4int GetScanEvents() const { return fScanEvents; }
+	void SetScanEvents(G4int n);
+
+	/// This job scans points job, job+njobs, job+2*njobs, ...
+	void SetScanSplit(G4int job, G4int njobs);
+	void GetScanSplit(G4int& job, G4int& njobs) const
+		{ job = fScanSplit[0]; njobs = fScanSplit[1]; }
+
+	/// Light (MeVee) above which a scan event counts as detected
+	G4double GetScanThreshold() const { return fScanThreshold; }
+	void SetScanThreshold(G4double thresh) { fScanThreshold = thresh; }
+
+	/// Text file of the per-point scan summary (see TntScan)
+	G4String GetScanSummary() const { return fScanSummary; }
+	void SetScanSummary(G4String file) { fScanSummary = file; }
+
+	/// Add detector configuration \a label of the geometry sweep
+	/** \a macro holds the /Tnt/detector/... commands of the configuration,
+	 *  applied on top of the input-file geometry as one geometry update.
+	 *  Configurations are run in the order they are added.
+	 */
+	void AddGeometryConfig(G4String label, G4String macro);
+	const std::vector<G4String>& GetGeometryLabels() const { return fGeometryLabels; }
+	const std::vector<G4String>& GetGeometryMacros() const { return fGeometryMacros; }
+
+	/// Events per configuration (and energy) of the geometry sweep
+	G4int GetGeometryEvents() const { return fGeometryEvents; }
+	void SetGeometryEvents(G4int n);
+
+	/// Incremented each time the detector is (re)built; the primary generators
+	/// set up their beam profile again when this differs from the version
+	/// they last saw.
+	G4int GetGeometryVersion() const { return fGeometryVersion; }
+	void IncrementGeometryVersion() { ++fGeometryVersion; }
 	
 private:
 	TntGlobalParams();
@@ -82,15 +310,59 @@ private:
 	G4int fNdetY;
 	G4String fBeamType;
 	G4String fReacFile;
+	G4String fPrimariesIn;
+	G4String fPrimariesOut;
+	G4String fNeutronsPerEvent;
+	G4int fPrimariesBatch;
 	G4String fInputFile;
 	G4String fRootFileName;
 	G4double fPhotonResolutionScale;
 	G4int fMenateR_Tracking;
+	G4String fMenateR_Sampler;
+	G4int fMenateR_Validate;
+	G4bool fMenateR_Benchmark;
+	G4bool fMenateR_Force;
+	G4bool fOpticalPhysics;
+	G4double fPhotonThreshold;
+	G4double fPhotonFraction;
+	G4double fPhotonWindow, fPhotonWindowMargin;
+	G4int fPhotonMaxReflections;
+	G4double fPhotonMaxPath;
+	G4String fLightMapFile;
+	G4String fLightMapMode;
+	G4String fLightMapDir;
+	G4String fOpticalTransport;
+	G4int fOpticalPacket;
+	G4String fWLSTransport;
+	G4int fLightMapGrid[3];
+	G4int fLightMapPhotons;
+	G4int fLightMapThreads;
 	G4String fScintMaterial;
 	G4double fDetectorX, fDetectorY, fDetectorZ, fSourceZ;
 	G4int fLightOutput;
 	G4double fQuantumEfficiency;
+	TntQECurve* fQECurve;
+	G4String fQEFile;
+	G4String fQEMode;
 	G4String fAngerAnalysis;
+	std::map<G4String, G4String> fXSFiles;
+	G4int fXSVersion;
+	std::vector<G4String> fXSCompareLabels;
+	std::map<G4String, std::map<G4String, G4String> > fXSCompareFiles;
+	std::vector<G4double> fXSCompareEnergies;
+	G4int fXSCompareEvents;
+	std::vector<G4double> fSweepEnergies;
+	G4int fSweepEvents;
+	G4double fScanMin[3], fScanStep[3];
+	G4int fScanPoints[3];
+	G4int fScanEvents;
+	G4int fScanSplit[2];
+	G4double fScanThreshold;
+	G4String fScanSummary;
+	std::vector<G4String> fGeometryLabels;
+	std::vector<G4String> fGeometryMacros;
+	G4int fGeometryEvents;
+	G4int fGeometryVersion;
 };
 
 
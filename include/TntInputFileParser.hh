@@ -131,6 +131,35 @@ private:
 };
 
 
+/// Any number of parameters of the same type
+template<class T, class ParameterSetter_t> 
+class TntKeyConverter_N : public TntKeyConverterBase {
+public:
+	TntKeyConverter_N(ParameterSetter_t* SetterClassInstance,
+										void (ParameterSetter_t::*setter)(std::vector<T>) ):
+		mInstance(SetterClassInstance),
+		mSetter(setter) { }
+
+	virtual ~TntKeyConverter_N() 
+		{  }
+
+	void Convert(const std::vector<std::string>& args)
+		{
+			std::vector<T> values;
+			for(size_t i=0; i< args.size(); ++i) {
+				std::stringstream sstr(args[i]);
+				T t; sstr >> t;
+				values.push_back(t);
+			}
+			(mInstance->*mSetter)(values);
+		}
+	
+private:
+	ParameterSetter_t *mInstance;
+	void (ParameterSetter_t::*mSetter)(std::vector<T>);
+};
+
+
 #if 0
 template<class ParameterSetter_t, class MemFun_t>
 class TntKeyConverter<std::string, ParameterSetter_t> : public TntKeyConverterBase {
@@ -196,6 +225,14 @@ public:
 			mInputs.insert(std::make_pair(key, keyConverter));
 		}
 
+	template<class T>
+	void AddInput(const std::string& key, void (ParameterSetter_t::*setter) (std::vector<T>))
+		{
+			TntKeyConverterBase *keyConverter = 
+				new TntKeyConverter_N<T, ParameterSetter_t> (mSetter, setter);
+			mInputs.insert(std::make_pair(key, keyConverter));
+		}
+
 	template<class T, class T1>
 	void AddInput(const std::string& key, void (ParameterSetter_t::*setter) (T, T1))
 		{
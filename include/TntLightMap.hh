@@ -0,0 +1,128 @@
+/// \file TntLightMap.hh
+/// \brief Definition of the TntLightMap class
+///
+#ifndef TntLightMap_h
+#define TntLightMap_h 1
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+/// Precomputed light-collection map of one scintillator cell
+/** Voxel grid over the scintillator (local coordinates, centred on the cell)
+ *  holding, for each voxel and PMT, the probability that an optical photon
+ *  born in the voxel is detected by that PMT, and the quantiles of the
+ *  detection-time offset (time of detection minus time of emission).
+ *
+ *  File layout (native endianness), read with mmap:
+ *  \code
+ *  128-byte header (TntLightMap::Header)
+ *  float    prob[nvox][npmt]
+ *  float    time[nvox][npmt][ntq] (ns, quantiles at i/(ntq-1))
+ *  \endcode
+ *  Maps are built by the 'lightmap_mode build' calibration run; the header
+ *  carries a hash of the geometry parameters (GetGeometryHash()).
+ */
+class TntLightMap
+{
+public:
+	enum EShape { kBox = 0, kCylinder = 1 };
+
+	/// Fixed-size file header
+	struct Header {
+		char     magic[8];
+		int32_t  version;
+		int32_t  shape;
+		uint64_t geometryHash;
+		double   size[3];
+		int32_t  nvx, nvy, nvz, npmt, ntq;
+		char     pad[60];
+	};
+
+	TntLightMap();
+	~TntLightMap();
+
+	/// Map a file into memory; returns false (and leaves the map empty) on failure
+	G4bool Read(const G4String& fileName);
+	/// Write the map to file; returns false on failure
+	G4bool Write(const G4String& fileName) const;
+
+	/// Set up an empty map in memory (all probabilities zero)
+	void Configure(G4int shape, const G4ThreeVector& size,
+								 G4int nvx, G4int nvy, G4int nvz, G4int npmt, G4int ntq);
+
+	G4bool IsLoaded() const { return fProb != 0; }
+	/// Release the file mapping and owned tables (IsLoaded() is then false)
+	void Clear();
+	/// True if the tables are mapped from a file (read-only)
+	G4bool IsMapped() const { return fMapAddr != 0; }
+
+	/// Check that the map was made for a scintillator of this shape, size and
+	/// PMT count (sizes agree to 1 um)
+	G4bool Matches(G4int shape, const G4ThreeVector& size, G4int npmt) const;
+
+	G4int GetShape() const { return fShape; }
+	const G4ThreeVector& GetSize() const { return fSize; }
+	G4int GetNumVoxels() const { return fNvx*fNvy*fNvz; }
+	void GetNumVoxels(G4int& nvx, G4int& nvy, G4int& nvz) const
+		{ nvx = fNvx; nvy = fNvy; nvz = fNvz; }
+	G4int GetNumPMTs() const { return fNpmt; }
+	G4int GetNumTimeQuantiles() const { return fNtq; }
+
+	/// Hash of the geometry parameters the map was built for (0 = unknown)
+	uint64_t GetGeometryHash() const { return fGeometryHash; }
+	void SetGeometryHash(uint64_t hash) { fGeometryHash = hash; }
+	/// 64-bit FNV-1a hash of a geometry description string
+	static uint64_t HashGeometry(const std::string& description);
+
+	/// Voxel containing \a localPos (scintillator frame), or -1 if outside the grid
+	G4int GetVoxel(const G4ThreeVector& localPos) const;
+	/// Lower corner and size of \a voxel (scintillator frame)
+	void GetVoxelBounds(G4int voxel, G4ThreeVector& corner, G4ThreeVector& width) const;
+
+	/// Probability that a photon born in \a voxel is detected by any PMT
+	G4double GetDetectionProbability(G4int voxel) const { return fTotal[voxel]; }
+	/// Probability that a photon born in \a voxel is detected by \a pmt
+	G4double GetDetectionProbability(G4int voxel, G4int pmt) const
+		{ return fProb[voxel*fNpmt + pmt]; }
+
+	/// PMT detecting a photon born in \a voxel, for a uniform deviate \a u in
+	/// [0,1); -1 if the photon is not detected
+	G4int SamplePMT(G4int voxel, G4double u) const;
+	/// Detection-time offset for \a pmt, for a uniform deviate \a u in [0,1)
+	G4double SampleTime(G4int voxel, G4int pmt, G4double u) const;
+
+	/// Fill one voxel/PMT entry of a map made with Configure()
+	/** Different voxels may be filled from different threads.
+	 *  \param [in] timeQuantiles ntq time offsets, increasing (ns units)
+	 */
+	void SetEntry(G4int voxel, G4int pmt, G4double prob,
+								const std::vector<G4double>& timeQuantiles);
+
+private:
+	TntLightMap(const TntLightMap&);
+	TntLightMap& operator=(const TntLightMap&);
+
+	/// Rebuild the per-voxel cumulative probabilities
+	void BuildCumulative();
+
+private:
+	G4int fShape;
+	G4ThreeVector fSize;
+	G4int fNvx, fNvy, fNvz;
+	G4int fNpmt;
+	G4int fNtq;
+	uint64_t fGeometryHash;
+	const float* fProb;
+	const float* fTime;
+	std::vector<float> fProbData; // tables owned when built in memory
+	std::vector<float> fTimeData;
+	void* fMapAddr;               // file mapping when read from file
+	size_t fMapSize;
+	std::vector<float> fCumProb;
+	std::vector<float> fTotal;
+};
+
+#endif
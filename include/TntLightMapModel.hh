@@ -0,0 +1,45 @@
+/// \file TntLightMapModel.hh
+/// \brief Definition of the TntLightMapModel class
+///
+#ifndef TntLightMapModel_h
+#define TntLightMapModel_h 1
+
+#include <vector>
+#include "G4VFastSimulationModel.hh"
+#include "globals.hh"
+
+class TntLightMap;
+class TntPMTSD;
+
+/// Fast-simulation model replacing optical photon tracking in the scintillator
+/** Attached to the scintillator region. Each optical photon is killed at
+ *  birth; with the probability stored in the light map for its voxel it is
+ *  counted as a hit on one PMT, at its birth time plus a time offset drawn
+ *  from the map. In "validate" mode the photons are tracked as usual and the
+ *  model only records the expected number of hits per PMT in the
+ *  TntUserEventInformation, for comparison in TntEventAction.
+ */
+class TntLightMapModel : public G4VFastSimulationModel
+{
+public:
+	TntLightMapModel(const G4String& name, G4Region* envelope,
+									 const TntLightMap* lightMap, G4bool validate);
+	virtual ~TntLightMapModel();
+
+	virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+	virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+	virtual void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+private:
+	/// PMT SD of detector \a copyNo (NULL if none), looked up by name once
+	TntPMTSD* GetPMTSD(G4int copyNo);
+
+private:
+	const TntLightMap* fLightMap;
+	G4bool fValidate;
+	/// One SD per detector of an array (copy number), one for a single detector
+	G4bool fArray;
+	std::vector<TntPMTSD*> fPMTSD;
+};
+
+#endif
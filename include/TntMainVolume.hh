@@ -54,9 +54,12 @@ public:
 
 	G4LogicalVolume* GetLogPhotoCath() {return fPhotocath_log;}
 	G4LogicalVolume* GetLogScint()     {return fScint_log;}
+	G4LogicalVolume* GetLogHousing()   {return fHousing_log;}
 	G4ThreeVector GetPos() const { return fPos; }
 	
 	std::vector<G4ThreeVector> GetPmtPositions() {return fPmtPositions;}
+	/// Size of the PMT faces (a cylinder fits them inside its end caps)
+	void GetPmtSize(G4double& x, G4double& y) const { x = fPmt_x; y = fPmt_y; }
 
 private:
 
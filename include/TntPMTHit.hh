@@ -69,6 +69,11 @@ class TntPMTHit : public G4VHit
     inline void IncPhotonCount(){fPhotons++;}
     inline G4int GetPhotonCount(){return fPhotons;}
 
+    //Sum of the weights of the detected photons (= GetPhotonCount() unless
+    //photons were thinned in TntStackingAction or an interaction was forced)
+    inline void AddPhotonWeight(G4double w){fWeightedPhotons+=w;}
+    inline G4double GetWeightedPhotonCount(){return fWeightedPhotons;}
+
   	inline void AddPhotonTime(G4double t){fPhotonTime.push_back(t);}
   	inline const std::vector<G4double>& GetPhotonTime(){return fPhotonTime;}
 	
@@ -88,6 +93,7 @@ class TntPMTHit : public G4VHit
 
     G4int fPmtNumber;
     G4int fPhotons;
+    G4double fWeightedPhotons;
     G4ThreeVector fPos;
     G4VPhysicalVolume* fPhysVol;
     G4bool fDrawit;
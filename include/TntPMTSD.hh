@@ -40,6 +40,7 @@
 
 class G4Step;
 class G4HCofThisEvent;
+class G4VPhysicalVolume;
 
 class TntPMTSD : public G4VSensitiveDetector
 {
@@ -55,6 +56,10 @@ class TntPMTSD : public G4VSensitiveDetector
     //A version of processHits that keeps aStep constant
     G4bool ProcessHits_constStep(const G4Step* ,
                                  G4TouchableHistory* );
+    //Count one photon (of track weight weight) detected by PMT pmtNumber at
+    //the given time
+    TntPMTHit* AddPhotonHit(G4int pmtNumber, G4double time, G4double weight,
+                            G4VPhysicalVolume* physVol=NULL);
     virtual void EndOfEvent(G4HCofThisEvent* );
     virtual void clear();
     void DrawAll();
@@ -47,6 +47,11 @@ class TntPhysicsList: public G4VModularPhysicsList
     // SetCuts()
     virtual void SetCuts();
 
+    // Adds the fast simulation process for optical photons when a light
+    // map or the analytic transport is used (see TntLightMapModel and
+    // TntRayTraceModel)
+    virtual void ConstructProcess();
+
 };
 
 #endif
@@ -0,0 +1,96 @@
+/// \file TntPrimaryFile.hh
+/// \brief Definition of the TntPrimaryFile class
+///
+#ifndef TntPrimaryFile_h
+#define TntPrimaryFile_h 1
+
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include "G4Threading.hh"
+#include "globals.hh"
+
+/// File of pre-generated primary neutrons
+/** One record per event of TntPGAReaction or TntPGAPhaseSpace (one neutron
+ *  of a reaction): the neutron and the reaction it comes from, as sent to
+ *  TntDataRecordTree. Written with 'primaries_out', read back by
+ *  TntPGAStream with 'primaries_in' so that the reaction and decay are
+ *  generated once for any number of detector configurations. The vertex z
+ *  is not stored: it follows the 'beamz' and 'dz' of the reading job.
+ *
+ *  File layout (native endianness, G4 units):
+ *  \code
+ *  64-byte header (TntPrimaryFile::Header)
+ *  Record   records[numRecords]
+ *  \endcode
+ *  One instance of each file is shared by all threads; records are read and
+ *  written in blocks under a lock.
+ */
+class TntPrimaryFile
+{
+public:
+	/// Fixed-size file header
+	struct Header {
+		char     magic[8];
+		int32_t  version;
+		int32_t  recordSize;
+		uint64_t numRecords;
+		char     pad[40];
+	};
+
+	/// One primary neutron
+	struct Record {
+		double  x, y;          // beam position on target
+		double  eNeut;         // neutron kinetic energy
+		double  dir[3];        // neutron momentum (direction)
+		double  beam[4];       // beam 4-momentum (px, py, pz, E)
+		double  ejectile[4];
+		double  recoil[4];     // heavy fragment after the decay
+		double  thetaCM;
+		double  targetMass;
+		int32_t neutron;       // index of the neutron in its reaction
+		int32_t numNeutrons;
+	};
+
+	/// The 'primaries_in' file (NULL if none); fatal if it cannot be read
+	static TntPrimaryFile* GetInput();
+	/// The 'primaries_out' file (NULL if none); fatal if it cannot be created
+	static TntPrimaryFile* GetOutput();
+
+	TntPrimaryFile();
+	~TntPrimaryFile();
+
+	/// Open a file for reading; returns false on failure
+	G4bool OpenRead(const G4String& fileName);
+	/// Create a file for writing; returns false on failure
+	G4bool OpenWrite(const G4String& fileName);
+
+	/// Read the next \a n records (fewer at the end of the file); once all
+	/// records are used, reading starts again from the first with a warning
+	G4int Read(Record* records, G4int n);
+	/// Append a record (written in blocks)
+	void Write(const Record& record);
+	/// Write the pending records and update the record count in the header
+	void Flush();
+
+	uint64_t GetNumRecords() const { return fNumRecords; }
+	const G4String& GetFileName() const { return fFileName; }
+
+private:
+	TntPrimaryFile(const TntPrimaryFile&);
+	TntPrimaryFile& operator=(const TntPrimaryFile&);
+
+	/// Write the pending records (lock held)
+	void WritePending();
+
+private:
+	G4String fFileName;
+	std::fstream fFile;
+	G4bool fWriting;
+	uint64_t fNumRecords;
+	uint64_t fNext;
+	std::vector<Record> fPending;
+	G4Mutex fMutex;
+};
+
+#endif
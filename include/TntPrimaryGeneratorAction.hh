@@ -32,10 +32,14 @@
 #ifndef TntPrimaryGeneratorAction_h
 #define TntPrimaryGeneratorAction_h 1
 #include <memory>
+#include <vector>
 #include "G4VUserPrimaryGeneratorAction.hh"
 
 //by Shuya 160407
 #include "TntDataRecordTree.hh"
+#include "TntPrimaryFile.hh"
+#include "TntBeamProfile.hh"
+#include "TntReactionSampler.hh"
 
 #include "g4gen/ReactionGenerator.hh"
 #include "g4gen/BeamEmittance.hh"
@@ -53,6 +57,25 @@ public:
 public:
 	virtual void GeneratePrimaries(G4Event* anEvent);
 
+protected:
+	/// Set up the beam profile and source z again if the detector was rebuilt
+	/// since they were (TntGlobalParams::GetGeometryVersion())
+	void UpdateGeometry();
+	/// Shoot the neutron of \a record from the beam position on target, send
+	/// it and its reaction to TntDataRecordTree and to 'primaries_out'
+	void GenerateNeutron(G4Event* anEvent, const TntPrimaryFile::Record& record);
+	/// Move on to the next neutron of a reaction with \a nNeut neutrons
+	/// (back to 0, i.e. a new reaction, after the last one)
+	void NextNeutron(G4int nNeut)
+		{ fWhichNeutron = fWhichNeutron+1 < nNeut ? fWhichNeutron+1 : 0; }
+	/// Shoot the next neutron (or all neutrons) of the current reaction,
+	/// taking a new reaction from SampleReaction() or from the batch sampler
+	/// ('primaries_batch') after its last neutron
+	void GenerateReaction(G4Event* anEvent);
+	/// Sample one reaction and append one record per neutron to \a records
+	/// (TntPGAReaction, TntPGAPhaseSpace; nothing for the standard beam)
+	virtual void SampleReaction(std::vector<TntPrimaryFile::Record>& /*records*/) { }
+
 protected:
 //by Shuya 160407
 	TntDataRecordTree* TntDataOutPG;
@@ -60,6 +83,24 @@ protected:
 	G4ParticleGun* fParticleGun;
 //by Shuya 160510
 	G4String BeamType;
+	/// Profile of 'beamtype' (NULL if unknown) and its source z
+	std::unique_ptr<TntBeamProfile> fBeamProfile;
+	G4double fBeamZ;
+	/// Geometry version the beam profile was set up for
+	G4int fGeometryVersion;
+	/// Neutron of the current reaction shot in this event. The neutrons of
+	/// one reaction go to consecutive events of the same thread (generator
+	/// actions are thread-local), with the reaction kept in fReac/fDecay.
+	G4int fWhichNeutron;
+	/// Shoot all neutrons of a reaction in one event ('neutrons_per_event all'),
+	/// one primary vertex each
+	G4bool fAllNeutrons;
+	/// Records of the current reaction, one per neutron
+	std::vector<TntPrimaryFile::Record> fReaction;
+	/// Batch sampler of SampleReaction() ('primaries_batch' > 0), started by
+	/// the first GenerateReaction(); derived classes stop it (reset) in their
+	/// destructor, before the generators it uses are deleted
+	std::unique_ptr<TntReactionSampler> fSampler;
 };
 
 class TntPGAReaction : public TntPrimaryGeneratorAction {
@@ -68,6 +109,9 @@ public:
 	virtual ~TntPGAReaction();
 	virtual void GeneratePrimaries(G4Event* anEvent);
 
+protected:
+	virtual void SampleReaction(std::vector<TntPrimaryFile::Record>& records);
+
 protected:
 	G4String fReacFile;
 	G4int fA[4], fZ[4];
@@ -83,6 +127,9 @@ public:
 	virtual ~TntPGAPhaseSpace();
 	virtual void GeneratePrimaries(G4Event* anEvent);
 
+protected:
+	virtual void SampleReaction(std::vector<TntPrimaryFile::Record>& records);
+
 protected:
 	G4int fN;
 	G4String fReacFile;
@@ -92,4 +139,42 @@ protected:
 	std::unique_ptr<g4gen::BeamEmittance> fEmX, fEmY;
 };
 
+/// Neutrons read from a file of pre-generated primaries ('primaries_in')
+/** The file is shared by all threads, each taking the next block of
+ *  records when its own block is used up. With 'neutrons_per_event all' the
+ *  records of one reaction go in the same event.
+ */
+class TntPGAStream : public TntPrimaryGeneratorAction {
+public:
+	TntPGAStream();
+	virtual ~TntPGAStream();
+	virtual void GeneratePrimaries(G4Event* anEvent);
+
+protected:
+	static const G4int kStreamBlock = 1024;
+	TntPrimaryFile* fInput;
+	std::vector<TntPrimaryFile::Record> fBuffer;
+	G4int fSize, fNext;
+};
+
+/// Optical photons for the 'lightmap_mode build' calibration run
+/** Event i launches 'lightmap_photons' photons from voxel i (modulo the
+ *  number of voxels) of the light map being built: uniform positions in the
+ *  voxel (inside the scintillator), isotropic directions, random linear
+ *  polarization and energies from the scintillator emission spectrum.
+ */
+class TntPGALightMap : public G4VUserPrimaryGeneratorAction {
+public:
+	TntPGALightMap();
+	virtual ~TntPGALightMap();
+	virtual void GeneratePrimaries(G4Event* anEvent);
+
+protected:
+	G4double SampleEnergy() const;
+
+protected:
+	G4int fNphotons;
+	std::vector<G4double> fEnergy, fCumSpectrum;
+};
+
 #endif
@@ -0,0 +1,37 @@
+/// \file TntQECurve.hh
+/// \brief Definition of the TntQECurve class
+///
+#ifndef TntQECurve_h
+#define TntQECurve_h 1
+
+#include <vector>
+#include "globals.hh"
+
+/// PMT quantum efficiency as a function of wavelength
+/** Read from a text file with two columns, wavelength (nm) and QE (0-1),
+ *  one point per line; lines starting with '#' are comments. The curve is
+ *  interpolated linearly and is zero outside the tabulated range.
+ */
+class TntQECurve
+{
+public:
+	TntQECurve();
+
+	/// Read the curve from \a fileName; returns false (curve empty) on failure
+	G4bool Read(const G4String& fileName);
+
+	G4bool IsLoaded() const { return !fWavelength.empty(); }
+
+	/// QE for an optical photon of energy \a photonEnergy
+	G4double GetQE(G4double photonEnergy) const;
+
+	/// Tabulated points as (photon energy, QE), in increasing energy, e.g. for
+	/// a G4MaterialPropertiesTable EFFICIENCY property
+	void GetEnergyTable(std::vector<G4double>& energy, std::vector<G4double>& qe) const;
+
+private:
+	std::vector<G4double> fWavelength; // increasing
+	std::vector<G4double> fQE;
+};
+
+#endif
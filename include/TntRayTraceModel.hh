@@ -0,0 +1,60 @@
+/// \file TntRayTraceModel.hh
+/// \brief Definition of the TntRayTraceModel class
+///
+#ifndef TntRayTraceModel_h
+#define TntRayTraceModel_h 1
+
+#include <vector>
+#include "G4VFastSimulationModel.hh"
+#include "globals.hh"
+#include "TntRayTracer.hh"
+
+class TntPMTSD;
+
+/// Fast-simulation model tracing optical photons analytically (TntRayTracer)
+/** Attached to the scintillator region ('optical_transport analytic'). Each
+ *  optical photon is traced to its fate at birth and killed; detected photons
+ *  are added to the PMT hits and losses to the TntUserEventInformation
+ *  counters, as for tracked photons. With 'optical_transport validate' the
+ *  photons are tracked as usual and the model only records the analytic
+ *  expectation of hits per PMT (average over a few traces of each photon),
+ *  compared with the tracked hits in TntEventAction.
+ *
+ *  With a packet size > 1 ('optical_packet') the photons are queued and
+ *  traced together with TntRayTracer::TracePacket() when the packet is full;
+ *  Flush() traces the rest and must be called before the PMT hits of the
+ *  event are read (TntEventAction::EndOfEventAction).
+ */
+class TntRayTraceModel : public G4VFastSimulationModel
+{
+public:
+	TntRayTraceModel(const G4String& name, G4Region* envelope,
+									 const TntRayTracer* rayTracer, G4bool validate, G4int packetSize);
+	virtual ~TntRayTraceModel();
+
+	virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+	virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+	virtual void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+	/// Trace the queued photons
+	void Flush();
+
+private:
+	/// Count the fate of a photon and add its PMT hit
+	void Record(const TntRayTracer::Result& result, G4double weight, G4int copyNo);
+	/// PMT SD of detector \a copyNo (NULL if none), looked up by name once
+	TntPMTSD* GetPMTSD(G4int copyNo);
+
+private:
+	const TntRayTracer* fRayTracer;
+	G4bool fValidate;
+	G4int fPacketSize;
+	TntRayTracer::Packet fPacket;
+	G4double fWeight[TntRayTracer::kMaxPacket];
+	G4int fCopyNo[TntRayTracer::kMaxPacket];
+	/// One SD per detector of an array (copy number), one for a single detector
+	G4bool fArray;
+	std::vector<TntPMTSD*> fPMTSD;
+};
+
+#endif
@@ -0,0 +1,133 @@
+/// \file TntRayTracer.hh
+/// \brief Definition of the TntRayTracer class
+///
+#ifndef TntRayTracer_h
+#define TntRayTracer_h 1
+
+#include <vector>
+#include "G4ThreeVector.hh"
+#include "G4MaterialPropertyVector.hh"
+#include "globals.hh"
+
+class G4MaterialPropertiesTable;
+
+/// Analytic optical photon transport in a box or cylinder scintillator
+/** Replaces G4Navigator + G4OpBoundaryProcess for the cells built by
+ *  TntMainVolume::CreateBox and CreateCylinder. Every surface of the
+ *  scintillator is a dielectric_metal skin: the housing (polished, specular
+ *  reflection with probability REFLECTIVITY, else absorbed) or a photocathode
+ *  (REFLECTIVITY 0, detected with probability EFFICIENCY). Photons travel in
+ *  straight lines between surfaces, with exponential bulk absorption from the
+ *  scintillator ABSLENGTH and speed from its GROUPVEL, as in G4OpAbsorption
+ *  and G4Track.
+ *
+ *  All coordinates are in the scintillator frame, centred on the cell.
+ *  Set up once in the master thread; Trace() and TracePacket() are const and
+ *  thread safe.
+ *
+ *  TracePacket() follows up to kMaxPacket photons together in
+ *  structure-of-arrays form, one surface crossing of every live photon per
+ *  pass, with the random numbers of a pass drawn in one call. The per-pass
+ *  loops are written so that the compiler can vectorize them (build with
+ *  TNTSIM_NATIVE_ARCH to use the host's SIMD instructions); Trace() is the
+ *  scalar version.
+ */
+class TntRayTracer
+{
+public:
+	enum EShape { kBox = 0, kCylinder = 1 };
+
+	/// Fate of a traced photon (kLoopLimit: stopped by the internal reflection
+	/// limit with 'photon_maxrefl' off, not counted as a cutoff)
+	enum EStatus { kDetected = 0, kBulkAbsorbed, kSurfaceAbsorbed,
+								 kCutTime, kCutReflections, kCutPath, kLoopLimit };
+
+	/// Result of Trace()
+	struct Result {
+		G4int status;
+		G4int pmt;          // PMT number if detected, else -1
+		G4double time;      // global time at the end of the photon
+		G4double path;      // path length travelled
+		G4int reflections;
+	};
+
+	/// Largest number of photons traced together by TracePacket()
+	static const G4int kMaxPacket = 16;
+
+	/// Photons traced together (scintillator frame), structure of arrays
+	struct Packet {
+		G4int size;
+		G4double x[kMaxPacket], y[kMaxPacket], z[kMaxPacket];
+		G4double dx[kMaxPacket], dy[kMaxPacket], dz[kMaxPacket];
+		G4double energy[kMaxPacket];
+		G4double time[kMaxPacket];
+	};
+
+	TntRayTracer();
+	~TntRayTracer();
+
+	/// Box scintillator of full size \a size
+	void SetBox(const G4ThreeVector& size);
+	/// Cylinder scintillator (axis along z)
+	void SetCylinder(G4double diameter, G4double length);
+
+	/// PMT windows: centres of the PMT volumes (TntMainVolume::GetPmtPositions)
+	/// and the size of their faces. The PMT number is the index in \a positions.
+	void SetPMTs(const std::vector<G4ThreeVector>& positions, G4double sizeX, G4double sizeY);
+
+	/// Optical properties of the scintillator, housing surface and photocathode
+	/// surface; returns false if a required property is missing
+	G4bool SetOptics(G4MaterialPropertiesTable* scint,
+									 G4MaterialPropertiesTable* housing,
+									 G4MaterialPropertiesTable* photocathode);
+
+	/// Photon cutoffs (G4 units), < 0 = off; see TntSteppingAction
+	void SetCutoffs(G4double timeCut, G4int maxReflections, G4double maxPath)
+		{ fTimeCut = timeCut; fMaxReflections = maxReflections; fMaxPath = maxPath; }
+
+	G4int GetShape() const { return fShape; }
+	G4int GetNumPMTs() const { return fNumPMTs; }
+
+	/// Trace one photon born at \a pos (scintillator frame) at time \a time
+	void Trace(const G4ThreeVector& pos, const G4ThreeVector& dir,
+						 G4double energy, G4double time, Result& result) const;
+	/// Trace the photons of \a packet (unit directions) together;
+	/// \a results gets packet.size entries
+	void TracePacket(const Packet& packet, Result* results) const;
+
+private:
+	TntRayTracer(const TntRayTracer&);
+	TntRayTracer& operator=(const TntRayTracer&);
+
+	/// PMT window on one face of the scintillator
+	struct Window {
+		G4int pmt;
+		G4double u0, u1, v0, v1; // extent in the in-plane coordinates of the face
+	};
+
+	/// Distance along \a dir to the scintillator surface, with the face hit
+	/// (0/1 = -z/+z, 2/3 = -x/+x, 4/5 = -y/+y, 6 = cylinder side)
+	G4double DistanceToOut(const G4ThreeVector& pos, const G4ThreeVector& dir, G4int& face) const;
+	/// Outward normal of \a face at \a pos
+	G4ThreeVector Normal(const G4ThreeVector& pos, G4int face) const;
+	/// PMT whose window contains \a pos on \a face, or -1
+	G4int FindPMT(const G4ThreeVector& pos, G4int face) const;
+
+private:
+	G4int fShape;
+	G4ThreeVector fHalf;  // half sizes (x = y = radius for a cylinder)
+	G4int fNumPMTs;
+	std::vector<Window> fWindows[6];
+
+	G4MaterialPropertyVector* fAbsLength;
+	G4MaterialPropertyVector* fGroupVel;
+	G4MaterialPropertyVector* fRindex;
+	G4MaterialPropertyVector* fReflectivity;
+	G4MaterialPropertyVector* fEfficiency;
+
+	G4double fTimeCut;
+	G4int fMaxReflections;
+	G4double fMaxPath;
+};
+
+#endif
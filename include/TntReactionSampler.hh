@@ -0,0 +1,73 @@
+/// \file TntReactionSampler.hh
+/// \brief Definition of the TntReactionSampler class
+///
+#ifndef TntReactionSampler_h
+#define TntReactionSampler_h 1
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <stdint.h>
+#include "TntPrimaryFile.hh"
+#include "globals.hh"
+
+/// Reaction kinematics pre-sampled in batches on a helper thread
+/** A producer thread calls the sampling function ('primaries_batch'
+ *  reactions per batch) into a ring of kNumBatches batches, and Next()
+ *  only copies out the records of the next reaction. Batch b is sampled
+ *  after g4gen::SetRngSeed(BatchSeed(seed, b)), and batches are consumed in
+ *  order, so the sequence of reactions depends on the seed only and not on
+ *  the timing of the threads.
+ *
+ *  The sampling function (TntPrimaryGeneratorAction::SampleReaction) runs
+ *  on the producer thread only: nothing else may use the g4gen generators
+ *  and random numbers while the sampler exists.
+ */
+class TntReactionSampler
+{
+public:
+	/// Appends the records of one reaction (one per neutron)
+	typedef std::function<void(std::vector<TntPrimaryFile::Record>&)> SampleFunction;
+
+	/// Start the producer thread
+	TntReactionSampler(const SampleFunction& sample, G4int batchSize, uint64_t seed);
+	/// Stop the producer thread (after the batch it is sampling)
+	~TntReactionSampler();
+
+	/// Append the records of the next reaction to \a records
+	void Next(std::vector<TntPrimaryFile::Record>& records);
+
+	/// Seed of batch \a batch (splitmix64 of the run seed and the batch
+	/// number, in [1, 2^31-1])
+	static G4int BatchSeed(uint64_t seed, uint64_t batch);
+
+private:
+	TntReactionSampler(const TntReactionSampler&);
+	TntReactionSampler& operator=(const TntReactionSampler&);
+
+	/// Producer thread
+	void Produce();
+
+private:
+	static const G4int kNumBatches = 3;
+
+	struct Batch {
+		std::vector<TntPrimaryFile::Record> records;
+		G4bool full;
+	};
+
+	SampleFunction fSample;
+	G4int fBatchSize;
+	uint64_t fSeed;
+	Batch fBatches[kNumBatches];
+	G4int fConsume;    // batch read by Next()
+	size_t fNext;      // next record of that batch
+	G4bool fStop;
+	std::mutex fMutex;
+	std::condition_variable fCondition;
+	std::thread fThread;
+};
+
+#endif
@@ -0,0 +1,65 @@
+/// \file TntScan.hh
+/// \brief Definition of the TntScan class
+///
+#ifndef TntScan_h
+#define TntScan_h 1
+
+#include <vector>
+#include "G4ThreeVector.hh"
+#include "G4Threading.hh"
+#include "globals.hh"
+
+/// Grid of 'beamtype scan' and its per-point summary
+/** The grid is the product of the 'scan_x', 'scan_y' and 'scan_z' points,
+ *  numbered with z running fastest. Each point gets 'scan_events'
+ *  consecutive events, and the point of an event follows from its event ID
+ *  alone, so that the result does not depend on which thread or job
+ *  simulates it. With 'scan_split job njobs' a job only scans points job,
+ *  job+njobs, ...: the summary files of the jobs together cover the grid.
+ *
+ *  For each point the summary has the mean light (MeVee), the fraction of
+ *  events with light above 'scan_threshold', and the photon-weighted
+ *  centroid of the PMT hits. Events are added under a lock; the summary is
+ *  written to 'scan_summary' at the end of each run.
+ */
+class TntScan
+{
+public:
+	/// The scan of 'beamtype scan' (NULL for other beam types)
+	static TntScan* GetInstance();
+
+	TntScan();
+	~TntScan();
+
+	/// Number of points in the full grid
+	G4int GetNumPoints() const;
+	/// Point scanned by event \a eventID
+	G4int GetPoint(G4int eventID) const;
+	/// Position of \a point (G4 units)
+	G4ThreeVector GetPosition(G4int point) const;
+
+	/// Add an event: light (MeVee), PMT photons and their centroid
+	void Fill(G4int eventID, G4double light, G4int photons, const G4ThreeVector& centroid);
+	/// Write the points with events to \a fileName
+	void Write(const G4String& fileName);
+
+private:
+	TntScan(const TntScan&);
+	TntScan& operator=(const TntScan&);
+
+	/// Sums over the events of one point
+	struct Point {
+		G4int events;
+		G4int detected;
+		G4double light, light2;
+		G4double photons;
+		G4ThreeVector centroid; // sum of photons * centroid
+	};
+
+private:
+	std::vector<Point> fPoints;
+	G4bool fWrapped;
+	G4Mutex fMutex;
+};
+
+#endif
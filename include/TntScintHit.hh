@@ -89,6 +89,8 @@ class TntScintHit : public G4VHit
       {ParticleA = theParticleMass;}
       void SetParticleProcess(G4String theProcess)
       {CreatorProcess = theProcess;}
+      void SetWeight(G4double theWeight)
+      {Weight = theWeight;}
 
 //by Shuya 160407
   // Get Data Methods (For EndofEventAction and DataRecordTree)
@@ -110,6 +112,8 @@ class TntScintHit : public G4VHit
       {return ParticleA; }
       G4String GetParticleProcess()
       {return CreatorProcess;}
+      G4double GetWeight()
+      {return Weight;}
 
   private:
     G4double fEdep;
@@ -125,6 +129,7 @@ class TntScintHit : public G4VHit
   G4double ParticleCharge; // Records Charge of Particle (PDG Charge!)
   G4double ParticleA;      // Records A of Particle (where "A" = Baryon Num)
   G4String CreatorProcess; // Records the "Process" creating the Track in Hit
+  G4double Weight;         // Records the track weight (biasing), 1 if analog
 
 };
 
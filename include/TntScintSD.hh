@@ -56,6 +56,10 @@ class TntScintSD : public G4VSensitiveDetector
 
 //by Shuya 160407
   G4double ConvertToLight(G4String theName, G4double theCharge, G4double edep, G4String Light);
+
+  /// Light (MeVee) of the hits recorded so far in this event, as in EndOfEvent()
+  /// but without resolution smearing or gamma veto (used by TntStackingAction)
+  G4double GetEventLight();
  
   private:
 
@@ -35,6 +35,23 @@
 #include "globals.hh"
 #include "G4UserStackingAction.hh"
 
+class TntQECurve;
+
+/// Stacking action counting optical photons by creator process
+/** With a 'photon_threshold' (TntGlobalParams::GetPhotonThreshold()) optical
+ *  photons are parked in the waiting stack while all other particles are
+ *  tracked. At the next stage the light of the scintillator hits so far is
+ *  compared with the threshold: below it the photons are dropped, otherwise
+ *  they are tracked as usual.
+ *
+ *  With a 'photon_fraction' f < 1 each new scintillation or Cerenkov photon
+ *  survives with probability f and has its track weight multiplied by 1/f.
+ *  TntPMTSD sums the weights next to the raw photon counts.
+ *
+ *  With a QE curve ('qe_file', 'qe_mode birth') each new scintillation or
+ *  Cerenkov photon is kept with probability QE(lambda), so only photons that
+ *  would be detected at a photocathode are tracked.
+ */
 class TntStackingAction : public G4UserStackingAction
 {
   public:
@@ -47,6 +64,17 @@ class TntStackingAction : public G4UserStackingAction
     virtual void PrepareNewEvent();
  
   private:
+
+    G4double fPhotonThreshold;
+    G4double fPhotonFraction;
+    const TntQECurve* fQECurve;   // applied at birth, NULL if not
+    G4bool fPhotonStage;    // photons of this event released from the waiting stack
+    G4int fNumEvents;       // events reaching the photon stage
+    G4int fNumDiscarded;    // ... of which below threshold
+    G4long fNumPhotonsDiscarded;
+    G4long fNumPhotonsCreated;    // scintillation/Cerenkov photons, before the roulette
+    G4long fNumPhotonsKilled;     // ... of which killed by the roulette
+    G4long fNumPhotonsQE;         // ... of which rejected by the QE
 };
 
 #endif
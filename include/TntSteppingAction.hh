@@ -59,6 +59,11 @@ class TntSteppingAction : public G4UserSteppingAction
     TntSteppingMessenger* fSteppingMessenger;
 
     G4OpBoundaryProcessStatus fExpectedNextStatus;
+
+    //Optical photon cutoffs (see TntGlobalParams), < 0 = off
+    G4double fPhotonTimeCut;
+    G4int fPhotonMaxReflections;
+    G4double fPhotonMaxPath;
 };
 
 #endif
@@ -31,6 +31,8 @@
 #include "G4VUserEventInformation.hh"
 #include "G4ThreeVector.hh"
 #include "globals.hh"
+#include <vector>
+#include <map>
 
 #ifndef TntUserEventInformation_h
 #define TntUserEventInformation_h 1
@@ -39,6 +41,9 @@ class TntUserEventInformation : public G4VUserEventInformation
 {
   public:
 
+    //Reasons for killing an optical photon in TntSteppingAction
+    enum EPhotonCut { kCutTime=0, kCutReflections, kCutPath, kNumPhotonCuts };
+
     TntUserEventInformation();
     virtual ~TntUserEventInformation();
 
@@ -47,6 +52,7 @@ class TntUserEventInformation : public G4VUserEventInformation
     void IncPhotonCount_Scint(){fPhotonCount_Scint++;}
     void IncPhotonCount_Ceren(){fPhotonCount_Ceren++;}
     void IncEDep(G4double dep){fTotE+=dep;}
+    void SetLight(G4double light){fLight=light;}
     void IncAbsorption(){fAbsorptionCount++;}
     void IncBoundaryAbsorption(){fBoundaryAbsorptionCount++;}
     void IncHitCount(G4int i=1){fHitCount+=i;}
@@ -60,6 +66,8 @@ class TntUserEventInformation : public G4VUserEventInformation
     G4int GetPhotonCount_Ceren()const {return fPhotonCount_Ceren;}
     G4int GetHitCount()const {return fHitCount;}
     G4double GetEDep()const {return fTotE;}
+    //Light output (MeVee) of the event, set by TntScintSD
+    G4double GetLight()const {return fLight;}
     G4int GetAbsorptionCount()const {return fAbsorptionCount;}
     G4int GetBoundaryAbsorptionCount() const {return fBoundaryAbsorptionCount;}
 
@@ -76,6 +84,35 @@ class TntUserEventInformation : public G4VUserEventInformation
     void IncPMTSAboveThreshold(){fPMTsAboveThreshold++;}
     G4int GetPMTSAboveThreshold(){return fPMTsAboveThreshold;}
 
+    //Expected number of hits per PMT from the light map ("lightmap_mode validate")
+    void AddExpectedPMTHits(G4int pmt,G4double mu){
+      if(pmt>=G4int(fExpectedPMTHits.size()))fExpectedPMTHits.resize(pmt+1,0.);
+      fExpectedPMTHits[pmt]+=mu;
+    }
+    const std::vector<G4double>& GetExpectedPMTHits()const{return fExpectedPMTHits;}
+
+    //Optical photons tracked, and killed by the cutoffs of TntSteppingAction
+    void IncPhotonTracked(){fPhotonTracked++;}
+    G4int GetPhotonTracked()const{return fPhotonTracked;}
+    void IncPhotonCut(EPhotonCut reason){fPhotonCutCount[reason]++;}
+    G4int GetPhotonCutCount(EPhotonCut reason)const{return fPhotonCutCount[reason];}
+
+    //WLS photons trapped in a fiber by TntWLSFiberModel, and photons reaching
+    //the fiber ends (with the sum of their arrival times)
+    void IncFiberCaptured(){fFiberCaptured++;}
+    G4int GetFiberCaptured()const{return fFiberCaptured;}
+    void AddFiberEndPhoton(G4double time){fFiberEndCount++;fFiberEndTime+=time;}
+    G4int GetFiberEndCount()const{return fFiberEndCount;}
+    G4double GetFiberEndTime()const{return fFiberEndTime;}
+
+    //Primary (index of its vertex in the event) each non-photon track
+    //descends from, set by TntTrackingAction; -1 if unknown
+    void SetPrimaryOfTrack(G4int trackID,G4int primary){fPrimaryOfTrack[trackID]=primary;}
+    G4int GetPrimaryOfTrack(G4int trackID)const{
+      std::map<G4int,G4int>::const_iterator it=fPrimaryOfTrack.find(trackID);
+      return it==fPrimaryOfTrack.end() ? -1 : it->second;
+    }
+
   private:
 
     G4int fHitCount;
@@ -85,6 +122,7 @@ class TntUserEventInformation : public G4VUserEventInformation
     G4int fBoundaryAbsorptionCount;
 
     G4double fTotE;
+    G4double fLight;
 
     //These only have meaning if totE > 0
     //If totE = 0 then these wont be set by EndOfEventAction
@@ -97,6 +135,17 @@ class TntUserEventInformation : public G4VUserEventInformation
 
     G4int fPMTsAboveThreshold;
 
+    std::vector<G4double> fExpectedPMTHits;
+
+    G4int fPhotonTracked;
+    G4int fPhotonCutCount[kNumPhotonCuts];
+
+    G4int fFiberCaptured;
+    G4int fFiberEndCount;
+    G4double fFiberEndTime;
+
+    std::map<G4int,G4int> fPrimaryOfTrack;
+
 };
 
 #endif
@@ -28,8 +28,8 @@
 /// \file optical/Tnt/include/TntWLSFiber.hh
 /// \brief Definition of the TntWLSFiber class
 //
-#ifndef TntMainVolume_H
-#define TntMainVolume_H 1
+#ifndef TntWLSFiber_H
+#define TntWLSFiber_H 1
 
 #include "G4PVPlacement.hh"
 #include "G4Box.hh"
@@ -52,11 +52,14 @@ class TntWLSFiber : public G4PVPlacement
                 G4int pCopyNo,
                 TntDetectorConstruction* c);
 
+    G4LogicalVolume* GetLogFiber(){return fFiber_log;}
+
   private:
 
     void CopyValues();
 
     static G4LogicalVolume* fClad2_log;
+    G4LogicalVolume* fFiber_log;
 
     G4double fFiber_rmin;
     G4double fFiber_rmax;
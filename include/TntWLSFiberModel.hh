@@ -0,0 +1,51 @@
+/// \file TntWLSFiberModel.hh
+/// \brief Definition of the TntWLSFiberModel class
+///
+#ifndef TntWLSFiberModel_h
+#define TntWLSFiberModel_h 1
+
+#include <vector>
+#include "G4VFastSimulationModel.hh"
+#include "G4MaterialPropertyVector.hh"
+#include "globals.hh"
+
+class G4VSolid;
+class G4MaterialPropertiesTable;
+
+/// Fast-simulation model replacing the tracking of WLS photons along a fiber
+/** Attached to the fiber cores of the WLS slab ('wls_transport param').
+ *  A photon re-emitted by OpWLS in the core is trapped if its angle of
+ *  incidence on the core wall is beyond the critical angle of the lowest
+ *  cladding index; in a straight fiber this angle is the same at every
+ *  reflection, so trapped photons reach the end they are heading for unless
+ *  absorbed on the way (WLSABSLENGTH and ABSLENGTH of the core). Those are
+ *  killed at birth and counted in TntUserEventInformation, with the arrival
+ *  time from the path length and the group velocity of the core. Untrapped
+ *  photons, and photons heading straight for an end, are tracked by Geant4.
+ */
+class TntWLSFiberModel : public G4VFastSimulationModel
+{
+public:
+	TntWLSFiberModel(const G4String& name, G4Region* envelope,
+									 G4MaterialPropertiesTable* core,
+									 const std::vector<G4MaterialPropertiesTable*>& cladding);
+	virtual ~TntWLSFiberModel();
+
+	virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+	virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+	virtual void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+private:
+	/// True if a photon at \a pos going along \a dir (core frame) is trapped
+	G4bool IsTrapped(const G4VSolid* core, const G4ThreeVector& pos,
+									 const G4ThreeVector& dir, G4double energy) const;
+
+private:
+	G4MaterialPropertyVector* fCoreRindex;
+	std::vector<G4MaterialPropertyVector*> fCladRindex;
+	G4MaterialPropertyVector* fGroupVel;
+	G4MaterialPropertyVector* fWLSAbsLength;
+	G4MaterialPropertyVector* fAbsLength;
+};
+
+#endif
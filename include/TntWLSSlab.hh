@@ -38,9 +38,12 @@
 #include "G4Material.hh"
 #include "G4LogicalVolume.hh"
 #include "G4OpticalSurface.hh"
+#include <vector>
 
 #include "TntDetectorConstruction.hh"
 
+class TntWLSFiber;
+
 class TntWLSSlab : public G4PVPlacement
 {
   public:
@@ -52,6 +55,8 @@ class TntWLSSlab : public G4PVPlacement
                G4int pCopyNo,
                TntDetectorConstruction* c);
 
+    const std::vector<TntWLSFiber*>& GetFibers(){return fFibers;}
+
   private:
 
     void CopyValues();
@@ -61,6 +66,7 @@ class TntWLSSlab : public G4PVPlacement
     static G4LogicalVolume* fScintSlab_log;
 
     G4int fNfibers;
+    std::vector<TntWLSFiber*> fFibers;
     G4double fScint_x;
     G4double fScint_y;
     G4double fScint_z;
@@ -125,8 +125,12 @@
 #include "G4VParticleChange.hh"
 
 #include "G4Material.hh"
+#include "G4Navigator.hh"
 #include "G4UnitsTable.hh"
 
+#include <vector>
+#include <algorithm>
+
 #include "G4SystemOfUnits.hh"
 #include "G4PhysicalConstants.hh"
 
@@ -197,6 +201,62 @@ public:
 }; 
 #endif 
 
+// Tabulated inverse CDF, Q(x,u), on a grid in a distribution parameter
+// "x" (e.g. neutron energy) times equally spaced points in u = [0,1].
+// Sampling is a bilinear interpolation in (x,u) with u = G4UniformRand().
+
+class InverseCDFTable
+{
+public:
+
+  InverseCDFTable() : NumU(0)
+  {;}
+
+  // Fills the table from theQuantile(x,u) on the (ascending) grid theX 
+  template<class Quantile_t>
+  void Build(const std::vector<G4double>& theX, G4int NumberOfU, Quantile_t theQuantile)
+  {
+    X = theX;
+    NumU = NumberOfU;
+    Values.resize(X.size()*NumU);
+    for(size_t i=0; i<X.size(); i++)
+      {
+	for(G4int j=0; j<NumU; j++)
+	  { Values[i*NumU+j] = theQuantile(X[i], static_cast<G4double>(j)/(NumU-1)); }
+      }
+  }
+
+  void Clear()
+  { X.clear(); Values.clear(); NumU = 0; }
+
+  G4bool InRange(G4double x) const
+  { return NumU > 1 && X.size() > 1 && x >= X.front() && x <= X.back(); }
+
+  // x must be InRange()
+  G4double Sample(G4double x, G4double u) const
+  {
+    size_t i = std::upper_bound(X.begin(), X.end(), x) - X.begin();
+    if(i >= X.size()) { i = X.size()-1; }
+    if(i > 0) { --i; }
+    G4double fx = (x-X[i])/(X[i+1]-X[i]);
+
+    G4double su = u*(NumU-1);
+    G4int j = static_cast<G4int>(su);
+    if(j >= NumU-1) { j = NumU-2; }
+    G4double fu = su-j;
+
+    const G4double* Low = &Values[i*NumU+j];
+    const G4double* High = Low+NumU;
+    return (1.-fx)*((1.-fu)*Low[0] + fu*Low[1]) + fx*((1.-fu)*High[0] + fu*High[1]);
+  }
+
+private:
+
+  std::vector<G4double> X;
+  std::vector<G4double> Values;  // Values[i*NumU+j] = Q(X[i], j/(NumU-1))
+  G4int NumU;
+};
+
 class menate_R : public G4VDiscreteProcess
 {
 public:
@@ -222,8 +282,22 @@ public:
   // This is the important function where you define the process
   // Returns steps, track and secondary particles
 
+  G4double PostStepGetPhysicalInteractionLength(const G4Track& aTrack, G4double previousStepSize,
+						G4ForceCondition* condition);
+  // With 'menate_force 1', steps a primary neutron directly to a forced
+  // first interaction (see SampleForcedInteraction), otherwise as in
+  // G4VDiscreteProcess
+
   void SetMeanFreePathCalcMethod(G4String Method);
 
+  // Reloads the cross section tables if the selection in TntGlobalParams
+  // ('xsfile' input key) has changed since they were last read.
+  void StartTracking(G4Track* aTrack);
+
+  // Called after physics construction (on each thread) - resolves the
+  // recoil ion definitions used in PostStepDoIt
+  void BuildPhysicsTable(const G4ParticleDefinition& aParticle);
+
 private:
 
  // Hide assignment operator as private 
@@ -242,9 +316,43 @@ private:
   G4double SIGN(G4double A1, G4double B2);
  
   // Returns Cross Section for a given element, energy
-  G4double GetCrossSection(G4double KinEng, CrossSectionClass* theXS);
-
-  void ReadCrossSectionFile(G4String FileName, CrossSectionClass* theXS);
+  G4double GetCrossSection(G4double KinEng, std::vector<CrossSectionClass>& theXS);
+
+  void ReadCrossSectionFile(G4String FileName, std::vector<CrossSectionClass>& theXS);
+
+  // Reads all cross section files, using the per-channel selection from
+  // TntGlobalParams where one is given and the MENATE_R defaults otherwise
+  void LoadCrossSections();
+
+  void ResolveParticleDefinitions();
+
+  // Mean free path in a material (mm), sets ProbDistPerReaction
+  G4double ComputeMeanFreePath(const G4Material* theMaterial, G4double theKinEng);
+
+  // Forced first interaction: integrates the optical depth Tau along the
+  // primary's line through the geometry and samples the interaction point
+  // from the exponential truncated to [0,Tau], with weight 1-exp(-Tau).
+  // Returns false if no H/C material is crossed.
+  G4bool SampleForcedInteraction(const G4Track& aTrack);
+
+  // Hydrogen/carbon content, MENATE atomic mass and density of a material,
+  // derived from its composition the first time it is seen
+  struct MaterialParams {
+    MaterialParams() : Valid(false), H_Switch(false), C_Switch(false),
+		       Num_H(0.), Num_C(0.), AMass(12.), Density(0.) {}
+    G4bool Valid;
+    G4bool H_Switch;
+    G4bool C_Switch;
+    G4double Num_H;    // atoms/mm3
+    G4double Num_C;    // atoms/mm3
+    G4double AMass;    // g/mole per carbon atom
+    G4double Density;  // g/cm3
+  };
+  const MaterialParams& GetMaterialParams(const G4Material* theMaterial);
+
+  // Prints interactions per second for each reaction channel
+  // ('menate_benchmark 1'), from the time spent in PostStepDoIt
+  void PrintBenchmark();
 
   G4double GetXSInterpolation(G4double KinEng, G4double LEng, G4double HEng, 
                                G4double LXS, G4double HXS);
@@ -261,6 +369,18 @@ private:
 
   G4double NP_AngDist(G4double NEng);
   G4double NC12_DIFF(G4double NEng);
+
+  // Exponential slope (in 1-cos(theta_cm)) of the n+12C diffractive peak
+  G4double NC12_Slope(G4double NEng);
+
+  // Inverse-CDF tables replacing the rejection/iterative samplers above
+  // ('menate_sampler table', default). Rebuilt in LoadCrossSections()
+  // since the n+12C slope depends on the carbon elastic cross section.
+  void BuildSamplerTables();
+
+  // Two-sample Kolmogorov-Smirnov comparison of the tables against the
+  // analytic samplers ('menate_validate <n>'), printed at construction
+  void ValidateSamplerTables(G4int NumSamples);
  
 private:
 
@@ -268,6 +388,10 @@ private:
 
   G4bool H_Switch;
   G4bool C_Switch; 
+  // Hydrogen/carbon in any material of the job (constructor scan); the
+  // switches above follow the material of the current step
+  G4bool Has_H;
+  G4bool Has_C;
 
   // Hold Number Density for H or C
   G4double Num_H;  
@@ -279,6 +403,9 @@ private:
   // Variables used in MENATE functions above
 
   G4double AMass_Material;  // Atomic Mass NE213 (according to MENATE)
+
+  // Indexed by G4Material::GetIndex()
+  std::vector<MaterialParams> theMaterialParams;
   G4String CalcMeth;
 
   // integers for ShareGammaEngC12 Function
@@ -288,16 +415,51 @@ private:
   G4double ProbDistPerReaction[10];
   G4double ProbTot;
 
-  CrossSectionClass theHydrogenXS[181];
-  CrossSectionClass theCarbonXS[852];
-
-  CrossSectionClass theC12NGammaXS[37];
-  CrossSectionClass theC12ABe9XS[32];
-  CrossSectionClass theC12NPB12XS[15];
-
-  CrossSectionClass theC12NNPB11XS[10];
-  CrossSectionClass theC12N2NC11XS[11];
-  CrossSectionClass theC12NN3AlphaXS[35];
+  // Sized from the line count in each file, so alternative
+  // evaluations (MENATEG4/other_files) can be read in as well
+  std::vector<CrossSectionClass> theHydrogenXS;
+  std::vector<CrossSectionClass> theCarbonXS;
+
+  std::vector<CrossSectionClass> theC12NGammaXS;
+  std::vector<CrossSectionClass> theC12ABe9XS;
+  std::vector<CrossSectionClass> theC12NPB12XS;
+
+  std::vector<CrossSectionClass> theC12NNPB11XS;
+  std::vector<CrossSectionClass> theC12N2NC11XS;
+  std::vector<CrossSectionClass> theC12NN3AlphaXS;
+
+  // TntGlobalParams::GetXSVersion() at the time of the last LoadCrossSections()
+  G4int XS_Version;
+
+  // Recoil ions, from G4IonTable::GetIon(Z,A,0.) - process is per-thread
+  G4ParticleDefinition* theC12Definition;
+  G4ParticleDefinition* theBe9Definition;
+  G4ParticleDefinition* theB12Definition;
+  G4ParticleDefinition* theB11Definition;
+  G4ParticleDefinition* theC11Definition;
+
+  // Forced first interaction of primary neutrons ('menate_force 1')
+  G4bool Force_Interaction;
+  G4bool Force_Sampled;     // already sampled for this track
+  G4bool Force_Pending;     // interaction sampled, not yet reached
+  G4double Force_Weight;    // 1-exp(-Tau)
+  G4double Force_Length;    // track length at the interaction point
+  G4Navigator* theForceNavigator;
+  std::vector<G4double> Force_SegDist;    // H/C segments along the line
+  std::vector<G4double> Force_SegLength;
+  std::vector<G4double> Force_SegTau;
+  std::vector<G4double> Force_SegMFP;
+
+  // Per-channel counts and time (s) in PostStepDoIt, index = reaction code-1
+  G4bool Benchmark;
+  G4double Bench_Time[8];
+  G4long Bench_Count[8];
+
+  G4bool Use_Sampler_Tables;
+  InverseCDFTable theNPAngDistTable;   // cos_cm vs. (NEng, u), NEng >= 29 MeV
+  InverseCDFTable theEvaporateTable;   // E/Available_Eng vs. (Available_Eng/T, sqrt(u))
+  std::vector<G4double> theNC12SlopeEng;  // NC12_Slope() vs. NEng, NEng >= 7.35 MeV
+  std::vector<G4double> theNC12Slope;
 
 
   // for storing current scattering element
@@ -71,7 +71,13 @@ namespace { struct phase_space_set {
 
 void TntActionInitialization::Build() const
 {
-	if(TntGlobalParams::Instance()->GetReacFile() == "0") {
+	if(TntGlobalParams::Instance()->GetLightMapBuild()) {
+		SetUserAction(new TntPGALightMap());
+		G4cout << "------ SETTING Light Map Calibration Generator -------" <<G4endl;
+	} else if(!TntGlobalParams::Instance()->GetPrimariesIn().empty()) {
+		SetUserAction(new TntPGAStream());
+		G4cout << "------ SETTING Pre-Generated Primaries Generator -------" <<G4endl;
+	} else if(TntGlobalParams::Instance()->GetReacFile() == "0") {
 		SetUserAction(new TntPrimaryGeneratorAction());
 		G4cout << "------ SETTING STANDARD Generator -------" <<G4endl;
 	} else {
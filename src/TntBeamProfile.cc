@@ -0,0 +1,203 @@
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "TntBeamProfile.hh"
+#include "TntGlobalParams.hh"
+#include "TntScan.hh"
+#include "TntDetectorConstruction.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+#include "G4RunManager.hh"
+
+TntBeamProfile::TntBeamProfile():
+	fBeamZ(ComputeBeamZ()),
+	fEventID(0),
+	fWeight(1.)
+{ }
+
+TntBeamProfile::~TntBeamProfile()
+{ }
+
+G4double TntBeamProfile::ComputeBeamZ()
+{
+	G4double detector_thickness = TntGlobalParams::Instance()->GetDetectorZ();
+	return (-1*TntGlobalParams::Instance()->GetSourceZ() - (detector_thickness/2))*cm;
+}
+
+std::map<G4String, TntBeamProfile::Factory>& TntBeamProfile::GetRegistry()
+{
+	static std::map<G4String, Factory> registry;
+	return registry;
+}
+
+G4bool TntBeamProfile::Register(const G4String& name, Factory factory)
+{
+	return GetRegistry().insert(std::make_pair(name, factory)).second;
+}
+
+TntBeamProfile* TntBeamProfile::Create(const G4String& name)
+{
+	std::map<G4String, Factory>::const_iterator it = GetRegistry().find(name);
+	return it == GetRegistry().end() ? 0 : it->second();
+}
+
+
+namespace {
+
+template<class T> TntBeamProfile* CreateProfile() { return new T(); }
+
+/// Straight pencil beam along z
+class TntBeamPencil : public TntBeamProfile {
+public:
+	virtual void Generate(G4ThreeVector& position, G4ThreeVector& direction)
+	{
+		position.set(0., 0., fBeamZ);
+		direction.set(0., 0., 1.);
+	}
+};
+
+/// Parallel beam, uniform over a square of the detector width
+class TntBeamRectangle : public TntBeamProfile {
+public:
+	TntBeamRectangle(): fWidth(TntGlobalParams::Instance()->GetDetectorX()*cm) { }
+	virtual void Generate(G4ThreeVector& position, G4ThreeVector& direction)
+	{
+		G4double posx = (G4UniformRand() - 0.5)*fWidth; // -0.5 -> 0.5
+		G4double posy = (G4UniformRand() - 0.5)*fWidth;
+		position.set(posx, posy, fBeamZ);
+		direction.set(0., 0., 1.);
+	}
+private:
+	G4double fWidth;
+};
+
+/// Scan of the 'scan_x', 'scan_y', 'scan_z' grid, along z (see TntScan)
+class TntBeamScan : public TntBeamProfile {
+public:
+	TntBeamScan(): fScan(TntScan::GetInstance()) { }
+	virtual void Generate(G4ThreeVector& position, G4ThreeVector& direction)
+	{
+		position = fScan->GetPosition(fScan->GetPoint(fEventID));
+		direction.set(0., 0., 1.);
+	}
+private:
+	TntScan* fScan;
+};
+
+/// Parallel beam with a diffuse, forward-focused beam spot
+/** "True" diffuse beam spot (BTR 11/01/08, following "BeamPosDet"): small
+ *  theta shaped like a cosine, to get a circular spot.
+ */
+class TntBeamDiffuse : public TntBeamProfile {
+public:
+	TntBeamDiffuse(): fRadius(15*cm*22.5) { } // correction factor
+	virtual void Generate(G4ThreeVector& position, G4ThreeVector& direction)
+	{
+		G4double theta = acos(1.-0.001*G4UniformRand());
+		G4double phi = twopi*G4UniformRand(); // Flat in phi
+		position.set(fRadius*cos(phi)*sin(theta), fRadius*sin(phi)*sin(theta), fBeamZ);
+		direction.set(0., 0., 1.);
+	}
+private:
+	G4double fRadius;
+};
+
+/// Cone from a point source (from Sega1, DEMON sims)
+/** The cone reaches 50 cm from the axis (half the detector height) at the
+ *  front of the detector.
+ */
+class TntBeamConic : public TntBeamProfile {
+public:
+	TntBeamConic(): fCosOpenAngle(cos(atan(50.*cm/fBeamZ))) { }
+	virtual void Generate(G4ThreeVector& position, G4ThreeVector& direction)
+	{
+		G4double theta = acos(1.+(fCosOpenAngle-1.)*G4UniformRand());
+		G4double phi = twopi*G4UniformRand(); // flat
+		position.set(0., 0., fBeamZ);
+		direction.set(sin(theta)*cos(phi), sin(theta)*sin(phi), cos(theta));
+	}
+private:
+	G4double fCosOpenAngle;
+};
+
+/// Point source of "conic", sampled only towards the detectors
+/** Directions are uniform within the cone subtended by one detector (the
+ *  sphere around its housing, TntDetectorConstruction::GetDetectorRadius),
+ *  picked with probability proportional to its solid angle. A direction in
+ *  k of the cones has density k/sum(omega), so the weight
+ *  sum(omega)/(k*omega_conic), or 0 outside the "conic" cone, gives the
+ *  same weighted sums as "conic". The cones are set up at the first event,
+ *  once the geometry exists.
+ */
+class TntBeamAcceptance : public TntBeamProfile {
+public:
+	TntBeamAcceptance():
+		fCosOpenAngle(cos(atan(50.*cm/fBeamZ))),
+		fConicOmega(twopi*(1. - fCosOpenAngle)),
+		fTotalOmega(0) { }
+	virtual void Generate(G4ThreeVector& position, G4ThreeVector& direction)
+	{
+		if(fCones.empty()) { SetupCones(); }
+
+		G4double r = fTotalOmega*G4UniformRand();
+		size_t i = 0;
+		while(i+1 < fCones.size() && r >= fCones[i].omega) { r -= fCones[i].omega; ++i; }
+
+		G4double cosTheta = 1. - (1. - fCones[i].cosAngle)*G4UniformRand();
+		G4double sinTheta = sqrt(std::max(0., 1. - cosTheta*cosTheta));
+		G4double phi = twopi*G4UniformRand();
+		direction.set(sinTheta*cos(phi), sinTheta*sin(phi), cosTheta);
+		direction.rotateUz(fCones[i].axis);
+		position.set(0., 0., fBeamZ);
+
+		G4int k = 0;
+		for(size_t j=0; j< fCones.size(); ++j) {
+			if(direction.dot(fCones[j].axis) >= fCones[j].cosAngle) { ++k; }
+		}
+		fWeight = direction.z() >= fCosOpenAngle ? fTotalOmega/(std::max(k, 1)*fConicOmega) : 0.;
+	}
+private:
+	struct Cone {
+		G4ThreeVector axis;
+		G4double cosAngle;
+		G4double omega;
+	};
+	void SetupCones()
+	{
+		const TntDetectorConstruction* detc = static_cast<const TntDetectorConstruction*>
+			(G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+		const G4double radius = detc->GetDetectorRadius();
+		for(G4int i=0; i< detc->GetNumDetectors(); ++i) {
+			G4double x, y;
+			detc->GetDetectorOffset(i, x, y);
+			Cone cone;
+			cone.axis = G4ThreeVector(x, y, -fBeamZ);
+			G4double dist = cone.axis.mag();
+			cone.axis /= dist;
+			cone.cosAngle = dist > radius ? sqrt(1. - radius*radius/(dist*dist)) : -1.;
+			cone.omega = twopi*(1. - cone.cosAngle);
+			fCones.push_back(cone);
+			fTotalOmega += cone.omega;
+		}
+		G4cout << "TntBeamAcceptance:: " << fCones.size() << " detector cones, "
+					 << fTotalOmega << " sr in total, against " << fConicOmega
+					 << " sr for 'conic'" << G4endl;
+	}
+private:
+	G4double fCosOpenAngle;
+	G4double fConicOmega;
+	G4double fTotalOmega;
+	std::vector<Cone> fCones;
+};
+
+const G4bool kRegistered =
+	TntBeamProfile::Register("pencil",    &CreateProfile<TntBeamPencil>) &&
+	TntBeamProfile::Register("rectangle", &CreateProfile<TntBeamRectangle>) &&
+	TntBeamProfile::Register("scan",      &CreateProfile<TntBeamScan>) &&
+	TntBeamProfile::Register("diffuse",   &CreateProfile<TntBeamDiffuse>) &&
+	TntBeamProfile::Register("conic",     &CreateProfile<TntBeamConic>) &&
+	TntBeamProfile::Register("acceptance", &CreateProfile<TntBeamAcceptance>);
+
+}
@@ -29,7 +29,9 @@
 
 #include "TntGlobalParams.hh"
 #include "TntDataRecordTree.hh"
+#include "TntUserEventInformation.hh"
 
+#include "G4EventManager.hh"
 #include "g4gen/Rng.hh"
 
 using namespace std;
@@ -57,6 +59,16 @@ const std::string ReactionNames[] = {
  "N_C12_NN3Alpha"
 };
 
+// Count, followed by the weighted sum and its error if any weight is not 1
+std::ostream& operator<< (std::ostream& os, const TntDataRecordTree::Tally_t& tally)
+{
+	os << tally.n;
+	if(tally.w != tally.n || tally.w2 != tally.n) {
+		os << " (weighted " << tally.w << " +- " << tally.Error() << ")";
+	}
+	return os;
+}
+
 }
 
 // Access to Analysis pointer! (see TntSD.cc EndOfEvent() for Example)
@@ -67,11 +79,10 @@ TntDataRecordTree::TntDataRecordTree(G4double Threshold) :
   eng_int(0), eng_Tnt(0), eng_Tnt_alpha(0), eng_Tnt_C12(0), 
   eng_Tnt_EG(0), eng_Tnt_Exotic(0),  FirstHitTime(0), FirstHitMag(0),
 //by Shuya 160407
-  eng_Tnt_PhotonFront(0), eng_Tnt_PhotonBack(0), eng_Tnt_PhotonTotal(0), number_Photon(0),
+  eng_Tnt_PhotonFront(0), eng_Tnt_PhotonBack(0), eng_Tnt_PhotonTotal(0),
+  eng_Tnt_PhotonFrontWeighted(0), eng_Tnt_PhotonBackWeighted(0),
   Xpos(0), Ypos(0), Zpos(0), Det_Threshold(Threshold),
-  event_counter(0), number_total(0), 
-  number_protons(0), number_alphas(0), number_C12(0), number_EG(0), 
-  number_Exotic(0), number_at_this_energy(0), efficiency(0),
+  event_counter(0), efficiency(0), EventWeight(1), EventAcceptance(1), fGeometry(0),
 //by Shuya 160502
   eng_Tnt_proton(0), edep_Tnt(0), edep_Tnt_proton(0), edep_Tnt_alpha(0), edep_Tnt_C12(0), edep_Tnt_EG(0), edep_Tnt_Exotic(0),
 //by Shuya 160504
@@ -84,6 +95,10 @@ TntDataRecordTree::TntDataRecordTree(G4double Threshold) :
 	// (GAC)
 	
   TntPointer = this;  // When Pointer is constructed, assigns address of this class to it.
+  photons_tracked = 0;
+  for(int i=0; i< 3; ++i) { photons_cut[i] = 0; }
+  fiber_captured = fiber_ends = 0;
+  fiber_end_time = 0;
   //
   // Create new data storage text file
   // Create new text file for data storage - (Data Recorded by TntDataRecordTree class)
@@ -244,6 +259,7 @@ TntDataRecordTree::TntDataRecordTree(G4double Threshold) :
 	TntInputTree->Branch("DX", &detector_x, "DX/D");
 	TntInputTree->Branch("DY", &detector_y, "DY/D");
 	TntInputTree->Branch("DZ", &detector_z, "DZ/D");
+	TntInputTree->Branch("GEOMETRY", &fGeometry, "GEOMETRY/I");
 	npmtX = TntGlobalParams::Instance()->GetNumPmtX();
 	npmtY = TntGlobalParams::Instance()->GetNumPmtY();
 	eNeut = TntGlobalParams::Instance()->GetNeutronEnergy();
@@ -252,6 +268,9 @@ TntDataRecordTree::TntDataRecordTree(G4double Threshold) :
 	detector_z = TntGlobalParams::Instance()->GetDetectorZ();
 	TntInputTree->Fill();
 	
+  // Job seed, before TntReactionSampler changes it batch by batch
+  fRngSeed = std::to_string(g4gen::GetRngSeed());
+
   TntEventTree = new TTree("t","Tnt Scintillator Simulation Data");
   TntEventTree->Branch("Energy_Initial",&eng_int,"eng_int/D");
   TntEventTree->Branch("LightOutput_Tnt",&eng_Tnt,"eng_Tnt/D");
@@ -271,6 +290,8 @@ TntDataRecordTree::TntDataRecordTree(G4double Threshold) :
   TntEventTree->Branch("Num_DetectedPhotonFront",&eng_Tnt_PhotonFront,"eng_Tnt_PhotonFront/I");
 //by Shuya 160427
   TntEventTree->Branch("Num_DetectedPhotonBack",&eng_Tnt_PhotonBack,"eng_Tnt_PhotonBack/I");
+  TntEventTree->Branch("Num_DetectedPhotonFrontWeighted",&eng_Tnt_PhotonFrontWeighted,"eng_Tnt_PhotonFrontWeighted/D");
+  TntEventTree->Branch("Num_DetectedPhotonBackWeighted",&eng_Tnt_PhotonBackWeighted,"eng_Tnt_PhotonBackWeighted/D");
 //by Shuya 160502
   TntEventTree->Branch("Num_CreatedPhotonTotal",&eng_Tnt_PhotonTotal,"eng_Tnt_PhotonTotal/I");
 //by Shuya 160504
@@ -280,6 +301,10 @@ TntDataRecordTree::TntDataRecordTree(G4double Threshold) :
   TntEventTree->Branch("First_Hit_Pos",&FirstHitMag,"FirstHitMag/D");
   TntEventTree->Branch("First_Hit_Time",&FirstHitTime,"FirstHitTime/D");
 
+  TntEventTree->Branch("Weight",&EventWeight,"Weight/D");
+  TntEventTree->Branch("Acceptance",&EventAcceptance,"Acceptance/D");
+  TntEventTree->Branch("Geometry",&fGeometry,"Geometry/I");
+
   TntEventTree->Branch("Xpos",&Xpos,"Xpos/D");
   TntEventTree->Branch("Ypos",&Ypos,"Ypos/D");
   TntEventTree->Branch("Zpos",&Zpos,"Zpos/D");
@@ -289,6 +314,8 @@ TntDataRecordTree::TntDataRecordTree(G4double Threshold) :
 	// 
 	TntEventTree->Branch("PhotonSum", &PhotonSum);
 	TntEventTree->Branch("PhotonSumFront", &PhotonSumFront);
+	TntEventTree->Branch("PhotonWeightSum", &PhotonWeightSum);
+	TntEventTree->Branch("PhotonWeightSumFront", &PhotonWeightSumFront);
 
 	// Digitizer histogram (see createdataPMT for more info)
 	hDigi = 0;
@@ -301,7 +328,9 @@ TntDataRecordTree::TntDataRecordTree(G4double Threshold) :
 	TntEventTree->Branch("HitT", &HitT);
 	TntEventTree->Branch("HitE", &HitE);
 	TntEventTree->Branch("HitTrackID", &HitTrackID);
+	TntEventTree->Branch("HitPrimary", &HitPrimary);
 	TntEventTree->Branch("HitType", &HitType);
+	TntEventTree->Branch("HitW", &HitW);
 	TntEventTree->Branch("NumHits", &NumHits);
 	//
 	//
@@ -320,6 +349,8 @@ TntDataRecordTree::TntDataRecordTree(G4double Threshold) :
 	TntEventTree->Branch("MenateHitsE", &fMenateHitsE);
 	TntEventTree->Branch("MenateHitsType", &fMenateHitsType);
 	TntEventTree->Branch("MenateHitsDetector", &fMenateHitsDetector);
+	TntEventTree->Branch("MenateHitsPrimary", &fMenateHitsPrimary);
+	TntEventTree->Branch("MenateHitsWeight", &fMenateHitsWeight);
 
 	
 	//
@@ -330,6 +361,13 @@ TntDataRecordTree::TntDataRecordTree(G4double Threshold) :
   TntEventTree->Branch("PrimaryZ",&PrimaryZ,"PrimaryZ/D");
 	TntEventTree->Branch("PrimaryMomentum", &PrimaryMomentum);
 	//
+	// All primaries of the event (several with 'neutrons_per_event all');
+	// the branches above hold the first one
+	fPrimaryEnergy = 0;
+	fPrimaries = new TClonesArray("TLorentzVector");
+	TntEventTree->Branch("PrimaryMomenta", &fPrimaries, 256000, 0);
+	fPrimaries->BypassStreamer();
+	//
 	// Secondary particles involved in the reaction (heavy fragment!!)
 	SecondaryMomentum = 0;
 	SecondaryPosition = 0;
@@ -415,8 +453,23 @@ TntDataRecordTree::~TntDataRecordTree()
 	// reaction file
 	write_file_to_root(TntGlobalParams::Instance()->GetReacFile(), "reacfile");
 
+	// optical photon cutoffs
+	if(photons_tracked > 0) {
+		TObjString objPhotonCuts(Form("TRACKED:: %li, TIME:: %li, REFLECTIONS:: %li, PATH:: %li",
+																	photons_tracked, photons_cut[0], photons_cut[1], photons_cut[2]));
+		objPhotonCuts.Write("PhotonCuts");
+	}
+
+	// WLS fiber transport
+	if(fiber_ends > 0 || fiber_captured > 0) {
+		TObjString objFiber(Form("CAPTURED:: %li, ENDS:: %li, MEANTIME:: %g",
+														 fiber_captured, fiber_ends,
+														 fiber_ends > 0 ? fiber_end_time/fiber_ends : 0.));
+		objFiber.Write("FiberEnds");
+	}
+
 	// seed
-	TObjString strSeed(std::to_string(g4gen::GetRngSeed()).c_str());
+	TObjString strSeed(fRngSeed.c_str());
 	strSeed.Write("seed");
 
 	
@@ -451,27 +504,31 @@ delete [] PmtBackHit;
 
 void TntDataRecordTree::senddataPG(double value1=0.)
 {
-	eng_int = value1;
+	fPrimaryEnergy = value1;
+	if(fPrimaries->GetEntriesFast() == 0) { eng_int = value1; }
 	event_counter++;
 	//  cout << "eng_int = " << eng_int << endl;
 }
 
 void TntDataRecordTree::senddataPrimary(const G4ThreeVector& pos, const G4ThreeVector& mom)
 {
-	PrimaryX = pos.x();
-	PrimaryY = pos.y();
-	PrimaryZ = pos.z();
-
 	TVector3 v(mom.x(), mom.y(), mom.z());
 	G4double theta = v.Theta(), phi = v.Phi();
 
 	const G4double MNEUT = 939.565378;
-	G4double etot = eng_int + MNEUT;
+	G4double etot = fPrimaryEnergy + MNEUT;
 	G4double ptot = sqrt(etot*etot - MNEUT*MNEUT);
-	PrimaryMomentum->SetPxPyPzE(ptot*sin(theta)*cos(phi), 
-															ptot*sin(theta)*sin(phi),
-															ptot*cos(theta), 
-															etot);
+	TLorentzVector* primary = new( (*fPrimaries)[fPrimaries->GetEntriesFast()] ) TLorentzVector();
+	primary->SetPxPyPzE(ptot*sin(theta)*cos(phi), 
+											ptot*sin(theta)*sin(phi),
+											ptot*cos(theta), 
+											etot);
+	if(fPrimaries->GetEntriesFast() > 1) { return; } // scalar branches: first primary
+
+	PrimaryX = pos.x();
+	PrimaryY = pos.y();
+	PrimaryZ = pos.z();
+	*PrimaryMomentum = *primary;
 }
 
 void TntDataRecordTree::senddataSecondary(const G4ThreeVector& pos, const G4LorentzVector& mom)
@@ -559,6 +616,18 @@ void TntDataRecordTree::senddataPMT(int id, int value1, int evid)
 	}
 }
 
+void TntDataRecordTree::senddataPMT_Weighted(int id, G4double value1)
+{
+	PhotonWeightSum.resize(NX*NY);
+	PhotonWeightSumFront.resize(NX*NY);
+	if(id < (NX*NY)) {	//Front side
+		PhotonWeightSumFront.at(id) = value1;
+	}
+	else if(id >= (NX*NY) && id < (2*NX*NY)) {	//Back side
+		PhotonWeightSum.at(id - NX*NY) = value1;
+	}
+}
+
 void TntDataRecordTree::senddataPMT_Time(int id, G4double time)
 {
 	if(id >= (NX*NY) && id < (2*NX*NY)) {	//Back side
@@ -601,6 +670,8 @@ h_Count_PMT_Front[evid]->GetYaxis()->SetTitle("Y (no.)");
 
 	PhotonSum.clear();
 	PhotonSumFront.clear();
+	PhotonWeightSum.clear();
+	PhotonWeightSumFront.clear();
 
 	// re-create digitizer histogram
 	// x-axis: signals as recorded by a CAEN V1730 digitizer (bins of 2 ns)
@@ -621,7 +692,7 @@ void TntDataRecordTree::senddataEV(int type, double value1)
 	case 1:
 		eng_Tnt = value1;  // Sum of all energy in event!
 		if (eng_Tnt > Det_Threshold)
-		{number_total++;
+		{number_total.Add(EventWeight);
 			//G4cout << "!!! " << eng_Tnt << G4endl;
 //G4cout << (TH1D*)DataFile->Get("Energy_Tnt") << "!! !!" << G4endl;
 //by Shuya 160426. Removed the histogram to replace with TTree.
@@ -633,7 +704,7 @@ void TntDataRecordTree::senddataEV(int type, double value1)
 	case 2:
 		eng_Tnt_proton = value1; 
 		if (eng_Tnt_proton > Det_Threshold)
-	  {number_protons++;
+	  {number_protons.Add(EventWeight);
 //by Shuya 160426. Removed the histogram to replace with TTree.
 			//((TH1D*)DataFile->Get("Energy_Proton"))->Fill(eng_Tnt_proton);
 			//h_Energy_Proton->Fill(eng_Tnt_proton);
@@ -642,7 +713,7 @@ void TntDataRecordTree::senddataEV(int type, double value1)
 	case 3:
 		eng_Tnt_alpha = value1;
 		if (eng_Tnt_alpha > Det_Threshold) 
-	  {number_alphas++;
+	  {number_alphas.Add(EventWeight);
 //by Shuya 160426. Removed the histogram to replace with TTree.
 			//((TH1D*)DataFile->Get("Energy_Alpha"))->Fill(eng_Tnt_alpha);
 			//h_Energy_Alpha->Fill(eng_Tnt_alpha);
@@ -651,7 +722,7 @@ void TntDataRecordTree::senddataEV(int type, double value1)
 	case 4:
 		eng_Tnt_C12 = value1; 
 		if (eng_Tnt_C12 > Det_Threshold)  
-	  {number_C12++;
+	  {number_C12.Add(EventWeight);
 //by Shuya 160426. Removed the histogram to replace with TTree.
 			//((TH1D*)DataFile->Get("Energy_C12"))->Fill(eng_Tnt_C12);
 			//h_Energy_C12->Fill(eng_Tnt_C12);
@@ -660,7 +731,7 @@ void TntDataRecordTree::senddataEV(int type, double value1)
 	case 5:
 		eng_Tnt_EG = value1; 
 		if (eng_Tnt_EG > Det_Threshold)  
-	  {number_EG++;
+	  {number_EG.Add(EventWeight);
 //by Shuya 160426. Removed the histogram to replace with TTree.
 			//((TH1D*)DataFile->Get("Energy_EG"))->Fill(eng_Tnt_EG);
 			//h_Energy_EG->Fill(eng_Tnt_EG);
@@ -669,7 +740,7 @@ void TntDataRecordTree::senddataEV(int type, double value1)
 	case 6:
 		eng_Tnt_Exotic = value1;  
 		if (eng_Tnt_Exotic > Det_Threshold)
-	  {number_Exotic++;
+	  {number_Exotic.Add(EventWeight);
 //by Shuya 160426. Removed the histogram to replace with TTree.
 			//((TH1D*)DataFile->Get("Energy_Exotic"))->Fill(eng_Tnt_Exotic);
 			//h_Energy_Exotic->Fill(eng_Tnt_Exotic);
@@ -679,7 +750,7 @@ void TntDataRecordTree::senddataEV(int type, double value1)
 	case 7:
 		eng_Tnt_PhotonFront = (int)value1;  
 		if (eng_Tnt_PhotonFront > Det_Threshold)
-	  {number_Photon++;
+	  {number_Photon.Add(EventWeight);
 //by Shuya 160426. Removed the histogram to replace with TTree.
 			//((TH1D*)DataFile->Get("Energy_Photon"))->Fill(eng_Tnt_Photon);
 			//h_Energy_Photon->Fill(eng_Tnt_Photon);
@@ -689,14 +760,14 @@ void TntDataRecordTree::senddataEV(int type, double value1)
 	case 8:
 		eng_Tnt_PhotonBack = (int)value1;  
 		if (eng_Tnt_PhotonBack > Det_Threshold)
-	  {number_Photon++;
+	  {number_Photon.Add(EventWeight);
 		}
 		break;
 //by Shuya 160502
 	case 9:
 		eng_Tnt_PhotonTotal = (int)value1;  
 		if (eng_Tnt_PhotonTotal > Det_Threshold)
-	  {number_Photon++;
+	  {number_Photon.Add(EventWeight);
 		}
 		break;
 //by Shuya 160502
@@ -722,6 +793,12 @@ void TntDataRecordTree::senddataEV(int type, double value1)
 	case 17:
 		num_Tnt_Abs = value1;  
 		break;
+	case 18:
+		eng_Tnt_PhotonFrontWeighted = value1;
+		break;
+	case 19:
+		eng_Tnt_PhotonBackWeighted = value1;
+		break;
 	default:
 		G4cout << "Data Transfer Error!" << G4endl;
 		G4ExceptionSeverity severity=FatalException;
@@ -762,7 +839,9 @@ void TntDataRecordTree::senddataHits(const std::vector<TntDataRecordTree::Hit_t>
 	HitT.resize(0);
 	HitE.resize(0);
 	HitTrackID.resize(0);
+	HitPrimary.resize(0);
 	HitType.resize(0);
+	HitW.resize(0);
 	NumHits = 0;
 	fHits->Clear();
 	fHit01->Clear();
@@ -777,7 +856,9 @@ void TntDataRecordTree::senddataHits(const std::vector<TntDataRecordTree::Hit_t>
 	HitT.reserve(hits.size());
 	HitE.reserve(hits.size());
 	HitTrackID.reserve(hits.size());
+	HitPrimary.reserve(hits.size());
 	HitType.reserve(hits.size());
+	HitW.reserve(hits.size());
 	NumHits = hits.size();
 	
 	for(std::vector<Hit_t>::const_iterator it = hits.begin();
@@ -790,7 +871,9 @@ void TntDataRecordTree::senddataHits(const std::vector<TntDataRecordTree::Hit_t>
 			HitT.push_back(it->T);
 			HitE.push_back(it->E);
 			HitTrackID.push_back(it->TrackID);
+			HitPrimary.push_back(GetPrimaryOfTrack(it->TrackID));
 			HitType.push_back(it->TrackID);
+			HitW.push_back(it->W);
 		}	else { // insert, sorted by time vector
 			std::vector<G4double>::iterator iT = 
 				std::lower_bound(HitT.begin(), HitT.end(), it->T);
@@ -804,8 +887,12 @@ void TntDataRecordTree::senddataHits(const std::vector<TntDataRecordTree::Hit_t>
 				(iT - HitT.begin()) + HitE.begin();
 			std::vector<G4int>::iterator iTrackID = 
 				(iT - HitT.begin()) + HitTrackID.begin();
+			std::vector<G4int>::iterator iPrimary = 
+				(iT - HitT.begin()) + HitPrimary.begin();
 			std::vector<G4int>::iterator iType = 
 				(iT - HitT.begin()) + HitType.begin();
+			std::vector<G4double>::iterator iW = 
+				(iT - HitT.begin()) + HitW.begin();
 
 			HitX.insert(iX, it->X);
 			HitY.insert(iY, it->Y);
@@ -813,7 +900,9 @@ void TntDataRecordTree::senddataHits(const std::vector<TntDataRecordTree::Hit_t>
 			HitT.insert(iT, it->T);
 			HitE.insert(iE, it->E);
 			HitTrackID.insert(iTrackID, it->TrackID);
+			HitPrimary.insert(iPrimary, GetPrimaryOfTrack(it->TrackID));
 			HitType.insert(iType, it->Type);
+			HitW.insert(iW, it->W);
 
 		}
 	}
@@ -886,17 +975,63 @@ void TntDataRecordTree::ShowDataFromEvent()
 #endif
 }
 
+void TntDataRecordTree::senddataWeightFactor(G4double factor)
+{
+	EventWeight *= factor;
+}
+
+void TntDataRecordTree::senddataAcceptance(G4double weight)
+{
+	EventAcceptance = weight;
+	EventWeight = weight;
+}
+
+void TntDataRecordTree::senddataGeometry(G4int index)
+{
+	fGeometry = index;
+	npmtX = TntGlobalParams::Instance()->GetNumPmtX();
+	npmtY = TntGlobalParams::Instance()->GetNumPmtY();
+	eNeut = TntGlobalParams::Instance()->GetNeutronEnergy();
+	detector_x = TntGlobalParams::Instance()->GetDetectorX();
+	detector_y = TntGlobalParams::Instance()->GetDetectorY();
+	detector_z = TntGlobalParams::Instance()->GetDetectorZ();
+	TntInputTree->Fill();
+}
+
+void TntDataRecordTree::senddataPhotonCuts(G4int tracked, G4int cutTime, G4int cutReflections, G4int cutPath)
+{
+	photons_tracked += tracked;
+	photons_cut[0] += cutTime;
+	photons_cut[1] += cutReflections;
+	photons_cut[2] += cutPath;
+}
+
+void TntDataRecordTree::senddataFiber(G4int captured, G4int ends, G4double endTime)
+{
+	fiber_captured += captured;
+	fiber_ends += ends;
+	fiber_end_time += endTime/ns;
+}
+
 void TntDataRecordTree::FillTree()
 {
+	number_events.Add(EventWeight);
 	if (eng_Tnt > Det_Threshold)  // Threshold set in main()
-	{number_at_this_energy++;}
+	{
+		number_at_this_energy.Add(EventWeight);
+	}
 	TntEventTree->Fill();  
 	HitCounter_MenateR = 0;
+	EventWeight = 1;
+	EventAcceptance = 1;
 
 	fMenateHitsPos->Clear();
 	fMenateHitsE.clear();
 	fMenateHitsType.clear();
 	fMenateHitsDetector.clear();
+	fMenateHitsPrimary.clear();
+	fMenateHitsWeight.clear();
+	fPrimaries->Clear();
 
 	//G4cout << "FillTree1!" << G4endl;
 }
@@ -951,6 +1086,7 @@ void TntDataRecordTree::FillTree2(int evid)
 void TntDataRecordTree::GetParticleTotals()
 {
 	cout << "The Initial Number of Beam Particles was: " << event_counter << endl;
+	cout << "The Number of Events was: " << number_events << endl;
 	cout << "The Detection Threshold is set at : " << Det_Threshold << " MeVee." << endl;
 	cout << "The Total Number of Detected Events was:  " << number_total << endl;
 	cout << "The Total Number of Protons Detected was: " << number_protons << endl;
@@ -959,6 +1095,31 @@ void TntDataRecordTree::GetParticleTotals()
 	cout << "The Total Number of e- or e+    was:      " << number_EG << endl;
 	cout << "The Total Number of Exotic Particles was: " << number_Exotic << endl;
 	cout << "The Total Number of Photons was: " << number_Photon << endl;
+	const TntGlobalParams* params = TntGlobalParams::Instance();
+	if(params->GetPhotonTimeCut() >= 0 || params->GetPhotonMaxReflections() >= 0 ||
+		 params->GetPhotonMaxPath() >= 0) {
+		const char* reasons[3] = { "time", "reflections", "path length" };
+		cout << "The Total Number of Optical Photons Tracked was: " << photons_tracked << endl;
+		for(int i=0; i< 3; ++i) {
+			cout << "  killed by the " << reasons[i] << " cutoff: " << photons_cut[i];
+			if(photons_tracked > 0) { cout << " (" << double(photons_cut[i])/photons_tracked << ")"; }
+			cout << endl;
+		}
+	}
+	if(fiber_ends > 0 || fiber_captured > 0) {
+		cout << "The Total Number of Photons Reaching the WLS Fiber Ends was: " << fiber_ends;
+		if(fiber_ends > 0) { cout << " (mean arrival time " << fiber_end_time/fiber_ends << " ns)"; }
+		cout << endl;
+		if(params->GetUseWLSParam()) {
+			cout << "  WLS photons trapped by the fiber parametrization: " << fiber_captured << endl;
+		}
+	}
+}
+
+void TntDataRecordTree::GetEfficiency(int nevents, double& eff, double& err) const
+{
+	eff = number_at_this_energy.w/static_cast<double>(nevents);
+	err = sqrt(std::max(0., number_at_this_energy.w2/nevents - eff*eff)/nevents);
 }
 
 void TntDataRecordTree::CalculateEff(int ch_eng)
@@ -966,31 +1127,42 @@ void TntDataRecordTree::CalculateEff(int ch_eng)
 	char EffFile[] = "eff_results_file.dat";
 	ofstream outfile2(EffFile,ios::app);
 
+	// Weighted sum - the same as the count of events above threshold
+	// unless a biasing scheme ('menate_force', 'beamtype acceptance') is on
 	cout << number_at_this_energy << endl;
-	efficiency = 100*(static_cast<double>(number_at_this_energy)/static_cast<double>(ch_eng));
-	cout << "Efficiency was: " << number_at_this_energy << "/" << ch_eng << " = " << efficiency << " %" << endl;
+	double error;
+	GetEfficiency(ch_eng, efficiency, error);
+	efficiency *= 100;
+	error *= 100;
+	cout << "Efficiency was: " << number_at_this_energy.w << "/" << ch_eng << " = " << efficiency 
+			 << " +- " << error << " %" << endl;
 
 	outfile2 << setiosflags(ios::fixed)
 					 << setprecision(4)
 					 << eng_int << "  "
-					 << efficiency 
+					 << efficiency << "  "
+					 << error
 					 << endl;
 	outfile2.close();
 
-	number_at_this_energy = 0;
+	ResetNumberAtThisEnergy();
 }
  
 void TntDataRecordTree::senddataMenateR(G4double ekin, 
 																				const G4ThreeVector& posn,
 																				G4int copyNo,
 																				G4double t,
-																				G4int type)
+																				G4int type,
+																				G4int trackID,
+																				G4double weight)
 {
 	if(HitCounter_MenateR == 0) {
 		fMenateHitsPos->Clear();
 		fMenateHitsE.clear();
 		fMenateHitsType.clear();
 		fMenateHitsDetector.clear();
+		fMenateHitsPrimary.clear();
+		fMenateHitsWeight.clear();
 	}
 
 	G4double zOffset = 	
@@ -1003,10 +1175,19 @@ void TntDataRecordTree::senddataMenateR(G4double ekin,
 	fMenateHitsE.push_back(ekin);
 	fMenateHitsType.push_back(type);
 	fMenateHitsDetector.push_back(copyNo);
+	fMenateHitsPrimary.push_back(GetPrimaryOfTrack(trackID));
+	fMenateHitsWeight.push_back(weight);
 
 	++HitCounter_MenateR;
 }
 
+G4int TntDataRecordTree::GetPrimaryOfTrack(G4int trackID) const
+{
+	const TntUserEventInformation* eventInformation = (const TntUserEventInformation*)
+		G4EventManager::GetEventManager()->GetUserInformation();
+	return eventInformation ? eventInformation->GetPrimaryOfTrack(trackID) : -1;
+}
+
 
 G4int TntDataRecordTree::GetParticleCode(const G4String& theParticleName) 
 {
@@ -40,7 +40,11 @@
 //////////////////////////////////////////////////////////////////////
 
 
+#include <cmath>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
 
 #include "TntDetectorConstruction.hh"
 #include "TntPMTSD.hh"
@@ -50,8 +54,16 @@
 #include "TntWLSSlab.hh"
 #include "TntGlobalParams.hh"
 #include "TntDataRecordTree.hh"
+#include "TntLightMap.hh"
+#include "TntLightMapModel.hh"
+#include "TntRayTracer.hh"
+#include "TntRayTraceModel.hh"
+#include "TntWLSFiber.hh"
+#include "TntWLSFiberModel.hh"
 
 #include "G4SDManager.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
 #include "G4RunManager.hh"
 
 #include "G4GeometryManager.hh"
@@ -97,6 +109,14 @@ TntDetectorConstruction::TntDetectorConstruction(G4String Light, int nx, int ny)
 
   fN = fO = fC = fH = NULL;
 
+  fLightMap = NULL;
+  fScintRegion = NULL;
+  fRayTracer = NULL;
+  fFiberRegion = NULL;
+
+  fUpdateDepth = 0;
+  fUpdatePending = false;
+
   SetDefaults();
 
   fDetectorMessenger = new TntDetectorMessenger(this);
@@ -104,7 +124,10 @@ TntDetectorConstruction::TntDetectorConstruction(G4String Light, int nx, int ny)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-TntDetectorConstruction::~TntDetectorConstruction() {}
+TntDetectorConstruction::~TntDetectorConstruction() {
+  delete fLightMap;
+  delete fRayTracer;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 //
@@ -251,6 +274,14 @@ void TntDetectorConstruction::DefineMaterials(){
   fPlexiglass->AddElement(fO,31.9614*perCent);
 *//////
  
+  // Set the Birks Constant for the Tnt and Polystyrene scintillators
+
+  fTnt->GetIonisation()->SetBirksConstant(0.126*mm/MeV);
+  fPstyrene->GetIonisation()->SetBirksConstant(0.126*mm/MeV);
+
+  // Optical properties are only needed when optical photons are tracked
+  if(!TntGlobalParams::Instance()->GetOpticalPhysics()) return;
+
   //***Material properties tables
 
 //////////////////////////// Comment By Shuya 160525. THIS IS TO CHANGE FOR SCINTILLATION MATERIALS (2/8) /////////////////////////////////
@@ -410,8 +441,8 @@ void TntDetectorConstruction::DefineMaterials(){
   //fTnt_mt->AddConstProperty("SCINTILLATIONYIELD",(12000.*0.2)/MeV);
 //Comment By Shuya 160512. Scintillation Yield: BC505=12000, BC519:9500, BC404=10400, EJ309=11500 (From Ejen catalogue). Anthracene~15000.
   //fTnt_mt->AddConstProperty("SCINTILLATIONYIELD",(9500.*0.2)/MeV);
-	G4double nphot = TntGlobalParams::Instance()->GetLightOutput() *
-		TntGlobalParams::Instance()->GetQuantumEfficiency(); // 10400.*0.2;
+	// (with a 'qe_file' the QE is applied per photon instead, see TntStackingAction)
+	G4double nphot = TntGlobalParams::Instance()->GetScintillationYield(); // 10400.*0.2;
 	fTnt_mt->AddConstProperty("SCINTILLATIONYIELD", nphot/MeV);
 
   // fTnt_mt->AddConstProperty("SCINTILLATIONYIELD",(10400.*0.2)/MeV);
@@ -470,11 +501,6 @@ void TntDetectorConstruction::DefineMaterials(){
   fTnt_mt->AddConstProperty("YIELDRATIO",1.0); // Ratio of fast / (fast+slow) ==> 1.0 means all fast
   fTnt->SetMaterialPropertiesTable(fTnt_mt);
 
-
-  // Set the Birks Constant for the Tnt scintillator
-
-  fTnt->GetIonisation()->SetBirksConstant(0.126*mm/MeV);
- 
 //by Shuya 160606. To test if the refractive index affects the photon detection at PMTs.
 /** \todo (GAC - 06/25/17) :: Do we need to set the glass refractive index equal to the scint ???? 
  */
@@ -515,10 +541,6 @@ void TntDetectorConstruction::DefineMaterials(){
   fMPTPStyrene->AddConstProperty("FASTTIMECONSTANT", 10.*ns);
   fPstyrene->SetMaterialPropertiesTable(fMPTPStyrene);
 
-  // Set the Birks Constant for the Polystyrene scintillator
-
-  fPstyrene->GetIonisation()->SetBirksConstant(0.126*mm/MeV);
-
   G4double RefractiveIndexFiber[]={ 1.60, 1.60, 1.60, 1.60};
   assert(sizeof(RefractiveIndexFiber) == sizeof(wls_Energy));
   G4double AbsFiber[]={9.00*m,9.00*m,0.1*mm,0.1*mm};
@@ -549,9 +571,24 @@ void TntDetectorConstruction::DefineMaterials(){
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+namespace {
+//Detach the root logical volumes of region, before the volume store deletes them
+void ClearRootVolumes(G4Region* region) {
+  if(!region) return;
+  std::vector<G4LogicalVolume*> volumes(region->GetRootLogicalVolumeIterator(),
+                                        region->GetRootLogicalVolumeIterator()
+                                        + region->GetNumberOfRootVolumes());
+  for(size_t i=0; i< volumes.size(); ++i)
+    region->RemoveRootLogicalVolume(volumes[i], false);
+}
+}
+
 G4VPhysicalVolume* TntDetectorConstruction::Construct(){
 
   if (fExperimentalHall_phys) {
+     //The fast-simulation regions get the volumes of the new geometry
+     ClearRootVolumes(fScintRegion);
+     ClearRootVolumes(fFiberRegion);
      G4GeometryManager::GetInstance()->OpenGeometry();
      G4PhysicalVolumeStore::GetInstance()->Clean();
      G4LogicalVolumeStore::GetInstance()->Clean();
@@ -560,7 +597,9 @@ G4VPhysicalVolume* TntDetectorConstruction::Construct(){
      G4LogicalBorderSurface::CleanSurfaceTable();
   }
 
-  DefineMaterials();
+  //Materials and their optical tables are kept when the geometry is rebuilt
+  if(!fTnt) DefineMaterials();
+  TntGlobalParams::Instance()->IncrementGeometryVersion();
   return ConstructDetector();
 }
 
@@ -638,14 +677,16 @@ G4cout << fNz << G4endl;
 			fMainVolume = fMainVolumeArray.at(0);
 			TntDataRecordTree::TntPointer->SaveDetectorPositions(vindx, vpos);
 		} // --- ARRAY ---
+		SetupLightMap();
+		SetupRayTracer();
   }
 
   //Place the WLS slab
   if(fWLSslab){
-    G4VPhysicalVolume* slab = new TntWLSSlab(0,G4ThreeVector(0.,0.,
-                                             -fScint_z/2.-fSlab_z-1.*cm),
-                                             fExperimentalHall_log,false,0,
-                                             this);
+    TntWLSSlab* slab = new TntWLSSlab(0,G4ThreeVector(0.,0.,
+                                      -fScint_z/2.-fSlab_z-1.*cm),
+                                      fExperimentalHall_log,false,0,
+                                      this);
 
     //Surface properties for the WLS slab
     G4OpticalSurface* scintWrap = new G4OpticalSurface("ScintWrap");
@@ -671,6 +712,12 @@ G4cout << fNz << G4endl;
     scintWrapProperty->AddProperty("REFLECTIVITY",pp,reflectivity,num);
     scintWrapProperty->AddProperty("EFFICIENCY",pp,efficiency,num);
     scintWrap->SetMaterialPropertiesTable(scintWrapProperty);
+
+    SetupFiberRegion(slab);
+  }
+  else if(TntGlobalParams::Instance()->GetUseWLSParam()){
+    TNTWAR << "Construct:: 'wls_transport param' has no effect without the WLS slab "
+           << "(/Tnt/detector/volumes/wls)" << G4endl;
   }
 
   return fExperimentalHall_phys;
@@ -681,35 +728,245 @@ G4cout << fNz << G4endl;
 void TntDetectorConstruction::ConstructSDandField() {
 	if(fMainVolumeArray.empty()) { ConstructSDandField1(); }
 	else { ConstructSDandFieldN(); }
+	ConstructLightMapModel();
+	ConstructRayTraceModel();
+	ConstructWLSFiberModel();
+}
+
+void TntDetectorConstruction::SetupLightMap() {
+	/** Read the light map (once, shared by all threads) and attach the
+	 *  scintillator logical volumes to the region of TntLightMapModel.
+	 *  In 'lightmap_mode build' set up the empty map to be filled instead,
+	 *  unless a map for this geometry and grid already exists.
+	 */
+	TntGlobalParams* params = TntGlobalParams::Instance();
+	G4bool build = params->GetLightMapBuild();
+	if(!(params->GetUseLightMap() || build) || !fMainVolume) { return; }
+
+	const G4String fileName = GetLightMapFileName();
+	const uint64_t hash = TntLightMap::HashGeometry(GetLightMapGeometry());
+	G4int shape = fScint_y > 0 ? TntLightMap::kBox : TntLightMap::kCylinder;
+	G4ThreeVector size(fScint_x, fScint_y > 0 ? fScint_y : fScint_x, fScint_z);
+	G4bool fileExists = std::ifstream(fileName.c_str()).good();
+	if(!fLightMap) { fLightMap = new TntLightMap(); }
+
+	if(build) {
+		if(!fMainVolumeArray.empty()) {
+			G4Exception("TntDetectorConstruction::SetupLightMap()", "TntLightMap03", FatalException,
+									"Build light maps with a single detector, the map of one cell is used for all cells of an array");
+		}
+		G4int nvx, nvy, nvz, mvx=0, mvy=0, mvz=0;
+		params->GetLightMapGrid(nvx, nvy, nvz);
+		if(fileExists && fLightMap->Read(fileName)) { fLightMap->GetNumVoxels(mvx, mvy, mvz); }
+		if(fLightMap->IsLoaded() && fLightMap->GetGeometryHash() == hash &&
+			 fLightMap->Matches(shape, size, GetNumPMTs()) && mvx == nvx && mvy == nvy && mvz == nvz) {
+			G4cout << "TntDetectorConstruction:: Light map " << fileName << " is up to date" << G4endl;
+		} else {
+			fLightMap->Configure(shape, size, nvx, nvy, nvz, GetNumPMTs(), 21);
+			fLightMap->SetGeometryHash(hash);
+		}
+		return;
+	}
+
+	// Read again when the geometry was rebuilt for a different map (e.g. by
+	// the geometry sweep of main())
+	if(!fLightMap->IsLoaded() || fileName != fLightMapFile || fLightMap->GetGeometryHash() != hash) {
+		fLightMap->Clear();
+		fLightMapFile = "";
+		if(params->GetLightMapFile() == "auto" && !fileExists) {
+			TNTWAR << "SetupLightMap:: No light map for this geometry (" << fileName
+						 << "), tracking all photons. Make one with 'lightmap_mode build'" << G4endl;
+			return;
+		}
+		if(!fLightMap->Read(fileName)) {
+			G4ExceptionDescription ed;
+			ed << "Could not read light map " << fileName;
+			G4Exception("TntDetectorConstruction::SetupLightMap()", "TntLightMap01",
+									FatalException, ed);
+		}
+		fLightMapFile = fileName;
+	}
+
+	if(!fLightMap->Matches(shape, size, GetNumPMTs()) || fLightMap->GetGeometryHash() != hash) {
+		G4ExceptionDescription ed;
+		ed << "Light map " << fileName << " (shape " << fLightMap->GetShape()
+			 << ", size " << fLightMap->GetSize()/mm << " mm, " << fLightMap->GetNumPMTs()
+			 << " PMTs) was not built for this detector (shape " << shape << ", size "
+			 << size/mm << " mm, " << GetNumPMTs() << " PMTs: " << GetLightMapGeometry() << ")";
+		G4Exception("TntDetectorConstruction::SetupLightMap()", "TntLightMap02",
+								FatalException, ed);
+	}
+
+	SetupScintRegion();
+}
+
+void TntDetectorConstruction::SetupRayTracer() {
+	/** Set up the analytic photon transport (once, shared by all threads) from
+	 *  the scintillator and surface properties of the first cell; the cells
+	 *  of an array are identical.
+	 */
+	TntGlobalParams* params = TntGlobalParams::Instance();
+	if(!params->GetUseRayTracing() || !fMainVolume) { return; }
+	if(fSphereOn) {
+		G4Exception("TntDetectorConstruction::SetupRayTracer()", "TntRayTrace01", FatalException,
+								"The analytic optical transport does not handle the sphere inside the scintillator");
+	}
+
+	G4LogicalSkinSurface* housingSkin = G4LogicalSkinSurface::GetSurface(fMainVolume->GetLogHousing());
+	G4LogicalSkinSurface* photocathSkin = G4LogicalSkinSurface::GetSurface(fMainVolume->GetLogPhotoCath());
+	G4OpticalSurface* housingSurface = housingSkin ?
+		dynamic_cast<G4OpticalSurface*>(housingSkin->GetSurfaceProperty()) : 0;
+	G4OpticalSurface* photocathSurface = photocathSkin ?
+		dynamic_cast<G4OpticalSurface*>(photocathSkin->GetSurfaceProperty()) : 0;
+
+	if(!fRayTracer) { fRayTracer = new TntRayTracer(); }
+	if(fScint_y > 0) { fRayTracer->SetBox(G4ThreeVector(fScint_x, fScint_y, fScint_z)); }
+	else             { fRayTracer->SetCylinder(fScint_x, fScint_z); }
+	G4double pmtx, pmty;
+	fMainVolume->GetPmtSize(pmtx, pmty);
+	fRayTracer->SetPMTs(fMainVolume->GetPmtPositions(), pmtx, pmty);
+	if(!housingSurface || !photocathSurface ||
+		 !fRayTracer->SetOptics(fTnt_mt, housingSurface->GetMaterialPropertiesTable(),
+														photocathSurface->GetMaterialPropertiesTable())) {
+		G4Exception("TntDetectorConstruction::SetupRayTracer()", "TntRayTrace02", FatalException,
+								"Missing scintillator RINDEX, housing REFLECTIVITY or photocathode EFFICIENCY");
+	}
+	G4double timeCut = params->GetPhotonTimeCut();
+	G4double maxPath = params->GetPhotonMaxPath();
+	fRayTracer->SetCutoffs(timeCut >= 0 ? timeCut*ns : -1, params->GetPhotonMaxReflections(),
+												 maxPath >= 0 ? maxPath*mm : -1);
+	SetupScintRegion();
+}
+
+void TntDetectorConstruction::SetupScintRegion() {
+	/** Region of the fast-simulation models replacing photon tracking in the
+	 *  scintillator (TntLightMapModel, TntRayTraceModel)
+	 */
+	fScintRegion = G4RegionStore::GetInstance()->GetRegion("TntScintRegion", false);
+	if(!fScintRegion) { fScintRegion = new G4Region("TntScintRegion"); }
+	if(fMainVolumeArray.empty()) {
+		fScintRegion->AddRootLogicalVolume(fMainVolume->GetLogScint());
+	} else {
+		for(size_t i=0; i< fMainVolumeArray.size(); ++i) {
+			fScintRegion->AddRootLogicalVolume(fMainVolumeArray.at(i)->GetLogScint());
+		}
+	}
+}
+
+void TntDetectorConstruction::SetupFiberRegion(TntWLSSlab* slab) {
+	/** Region of TntWLSFiberModel: the cores of the fibers in the WLS slab
+	 */
+	if(!TntGlobalParams::Instance()->GetUseWLSParam()) { return; }
+	if(!fPMMA->GetMaterialPropertiesTable() ||
+		 !fPMMA->GetMaterialPropertiesTable()->GetProperty("RINDEX") ||
+		 !fPethylene1->GetMaterialPropertiesTable() ||
+		 !fPethylene1->GetMaterialPropertiesTable()->GetProperty("RINDEX") ||
+		 !fPethylene2->GetMaterialPropertiesTable() ||
+		 !fPethylene2->GetMaterialPropertiesTable()->GetProperty("RINDEX")) {
+		G4Exception("TntDetectorConstruction::SetupFiberRegion()", "TntWLSFiber01", FatalException,
+								"The parametrized fiber transport needs the RINDEX of the fiber core and claddings");
+	}
+	fFiberRegion = G4RegionStore::GetInstance()->GetRegion("TntFiberRegion", false);
+	if(!fFiberRegion) { fFiberRegion = new G4Region("TntFiberRegion"); }
+	for(size_t i=0; i< slab->GetFibers().size(); ++i) {
+		fFiberRegion->AddRootLogicalVolume(slab->GetFibers().at(i)->GetLogFiber());
+	}
+}
+
+G4String TntDetectorConstruction::GetLightMapGeometry() {
+	/** Everything the photon transport to the PMTs depends on. The light
+	 *  yield does not enter, nor does the QE unless 'qe_mode boundary' puts
+	 *  the QE curve on the photocathode (efficiency 1 otherwise)
+	 */
+	TntGlobalParams* params = TntGlobalParams::Instance();
+	std::ostringstream geo;
+	geo << std::setprecision(9)
+			<< "shape=" << (fScint_y > 0 ? "box" : "cylinder")
+			<< " x=" << fScint_x/mm << " y=" << fScint_y/mm << " z=" << fScint_z/mm
+			<< " housing=" << fD_mtl/mm << " refl=" << fRefl
+			<< " nx=" << fNx << " ny=" << fNy << " nz=" << fNz
+			<< " pmtx=" << fPmt_x/mm << " pmty=" << fPmt_y/mm
+			<< " scint=" << params->GetScintMaterial();
+	if(params->GetQECurve() && params->GetQEMode() == "boundary") {
+		geo << " qe=boundary:" << params->GetQEFile();
+	}
+	return geo.str();
+}
+
+G4String TntDetectorConstruction::GetLightMapFileName() {
+	/** 'lightmap <file>', or <lightmap_dir>/tntlmap_<geometry hash>.lmap for
+	 *  'lightmap auto' (and for 'lightmap_mode build' without a file)
+	 */
+	TntGlobalParams* params = TntGlobalParams::Instance();
+	if(!params->GetLightMapFile().empty() && params->GetLightMapFile() != "auto") {
+		return params->GetLightMapFile();
+	}
+	std::ostringstream name;
+	name << params->GetLightMapDir() << "/tntlmap_" << std::hex << std::setw(16)
+			 << std::setfill('0') << TntLightMap::HashGeometry(GetLightMapGeometry()) << ".lmap";
+	return name.str();
+}
+
+void TntDetectorConstruction::ConstructLightMapModel() {
+	/** One model per thread, attached to the region made in SetupLightMap()
+	 */
+	if(!fScintRegion || !fLightMap || fLightMapModel.Get() ||
+		 !TntGlobalParams::Instance()->GetUseLightMap()) { return; }
+	G4bool validate = TntGlobalParams::Instance()->GetLightMapMode() == "validate";
+	fLightMapModel.Put(new TntLightMapModel("TntLightMapModel", fScintRegion, fLightMap, validate));
+}
+
+void TntDetectorConstruction::ConstructRayTraceModel() {
+	/** One model per thread, attached to the region made in SetupRayTracer()
+	 */
+	if(!fScintRegion || !fRayTracer || fRayTraceModel.Get()) { return; }
+	G4bool validate = TntGlobalParams::Instance()->GetOpticalTransport() == "validate";
+	fRayTraceModel.Put(new TntRayTraceModel("TntRayTraceModel", fScintRegion, fRayTracer, validate,
+																					TntGlobalParams::Instance()->GetOpticalPacket()));
+}
+
+void TntDetectorConstruction::ConstructWLSFiberModel() {
+	/** One model per thread, attached to the region made in SetupFiberRegion()
+	 */
+	if(!fFiberRegion || fWLSFiberModel.Get()) { return; }
+	std::vector<G4MaterialPropertiesTable*> cladding;
+	cladding.push_back(fPethylene1->GetMaterialPropertiesTable());
+	cladding.push_back(fPethylene2->GetMaterialPropertiesTable());
+	fWLSFiberModel.Put(new TntWLSFiberModel("TntWLSFiberModel", fFiberRegion,
+																					fPMMA->GetMaterialPropertiesTable(), cladding));
 }
 
 void TntDetectorConstruction::ConstructSDandField1() {
 
   if (!fMainVolume) return;
 
-  // PMT SD
+  // PMT SD (not needed without optical photons)
 
-  if (!fPmt_SD.Get()) {
-    //Created here so it exists as pmts are being placed
-    G4cout << "Construction /TntDet/pmtSD" << G4endl;
-    TntPMTSD* pmt_SD = new TntPMTSD("/TntDet/pmtSD");
-    fPmt_SD.Put(pmt_SD);
+  if (TntGlobalParams::Instance()->GetOpticalPhysics()) {
+    if (!fPmt_SD.Get()) {
+      //Created here so it exists as pmts are being placed
+      G4cout << "Construction /TntDet/pmtSD" << G4endl;
+      TntPMTSD* pmt_SD = new TntPMTSD("/TntDet/pmtSD");
+      fPmt_SD.Put(pmt_SD);
 
-    pmt_SD->InitPMTs((fNx*fNy+fNx*fNz+fNy*fNz)*2); //let pmtSD know # of pmts
-    pmt_SD->SetPmtPositions(fMainVolume->GetPmtPositions());
-  }
+      pmt_SD->InitPMTs(GetNumPMTs()); //let pmtSD know # of pmts
+      pmt_SD->SetPmtPositions(fMainVolume->GetPmtPositions());
+    }
 
-  //sensitive detector is not actually on the photocathode.
-  //processHits gets done manually by the stepping action.
-  //It is used to detect when photons hit and get absorbed&detected at the
-  //boundary to the photocathode (which doesnt get done by attaching it to a
-  //logical volume.
-  //It does however need to be attached to something or else it doesnt get
-  //reset at the begining of events
+    //sensitive detector is not actually on the photocathode.
+    //processHits gets done manually by the stepping action.
+    //It is used to detect when photons hit and get absorbed&detected at the
+    //boundary to the photocathode (which doesnt get done by attaching it to a
+    //logical volume.
+    //It does however need to be attached to something or else it doesnt get
+    //reset at the begining of events
 
-  SetSensitiveDetector(fMainVolume->GetLogPhotoCath(), fPmt_SD.Get());
+    SetSensitiveDetector(fMainVolume->GetLogPhotoCath(), fPmt_SD.Get());
+  }
 
-  // Scint SD
+  // Scint SD (not needed when only optical photons are launched)
+
+  if (TntGlobalParams::Instance()->GetLightMapBuild()) return;
 
   if (!fScint_SD.Get()) {
     G4cout << "Construction /TntDet/scintSD" << G4endl;
@@ -729,34 +986,36 @@ void TntDetectorConstruction::ConstructSDandFieldN() {
 		fMainVolume = fMainVolumeArray.at(i);
 		if (!fMainVolume) return;
 
-		// PMT SD
+		// PMT SD (not needed without optical photons)
 
-		// if (!fPmt_SD.Get()) {
-		// 	//Created here so it exists as pmts are being placed
-		// 	G4cout << "Construction /TntDet/pmtSD" << G4endl;
+		if (TntGlobalParams::Instance()->GetOpticalPhysics()) {
+			// if (!fPmt_SD.Get()) {
+			// 	//Created here so it exists as pmts are being placed
+			// 	G4cout << "Construction /TntDet/pmtSD" << G4endl;
 
-		G4String pmtname = "/TntDet/pmtSD" + std::to_string(i);
-		TntPMTSD* pmt_SD = new TntPMTSD(pmtname.c_str());
-		fPmt_SD.Put(pmt_SD);
+			G4String pmtname = "/TntDet/pmtSD" + std::to_string(i);
+			TntPMTSD* pmt_SD = new TntPMTSD(pmtname.c_str());
+			fPmt_SD.Put(pmt_SD);
 		
-		pmt_SD->InitPMTs((fNx*fNy+fNx*fNz+fNy*fNz)*2); //let pmtSD know # of pmts
+			pmt_SD->InitPMTs(GetNumPMTs()); //let pmtSD know # of pmts
 
-		std::vector<G4ThreeVector> pmtPos = fMainVolume->GetPmtPositions();
-		for(auto& p : pmtPos) {
-			p[0] += fOffsetX.at(i);
-			p[1] += fOffsetY.at(i);
-		}
-		pmt_SD->SetPmtPositions(pmtPos);
+			std::vector<G4ThreeVector> pmtPos = fMainVolume->GetPmtPositions();
+			for(auto& p : pmtPos) {
+				p[0] += fOffsetX.at(i);
+				p[1] += fOffsetY.at(i);
+			}
+			pmt_SD->SetPmtPositions(pmtPos);
 
-  //sensitive detector is not actually on the photocathode.
-  //processHits gets done manually by the stepping action.
-  //It is used to detect when photons hit and get absorbed&detected at the
-  //boundary to the photocathode (which doesnt get done by attaching it to a
-  //logical volume.
-  //It does however need to be attached to something or else it doesnt get
-  //reset at the begining of events
+			//sensitive detector is not actually on the photocathode.
+			//processHits gets done manually by the stepping action.
+			//It is used to detect when photons hit and get absorbed&detected at the
+			//boundary to the photocathode (which doesnt get done by attaching it to a
+			//logical volume.
+			//It does however need to be attached to something or else it doesnt get
+			//reset at the begining of events
 
-		SetSensitiveDetector(fMainVolume->GetLogPhotoCath(), fPmt_SD.Get());
+			SetSensitiveDetector(fMainVolume->GetLogPhotoCath(), fPmt_SD.Get());
+		}
 
   // Scint SD
 
@@ -774,60 +1033,86 @@ void TntDetectorConstruction::ConstructSDandFieldN() {
 
 
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TntDetectorConstruction::BeginUpdate() {
+  ++fUpdateDepth;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TntDetectorConstruction::EndUpdate() {
+  if(fUpdateDepth == 0) {
+    TNTWAR << "EndUpdate:: No geometry update in progress" << G4endl;
+    return;
+  }
+  if(--fUpdateDepth == 0 && fUpdatePending) {
+    fUpdatePending = false;
+    G4RunManager::GetRunManager()->ReinitializeGeometry();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TntDetectorConstruction::GeometryChanged() {
+  if(fUpdateDepth > 0) fUpdatePending = true;
+  else G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetDimensions(G4ThreeVector dims) {
   this->fScint_x=dims[0];
   this->fScint_y=dims[1];
   this->fScint_z=dims[2];
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
  
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetHousingThickness(G4double d_mtl) {
   this->fD_mtl=d_mtl;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetNX(G4int nx) {
   this->fNx=nx;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetNY(G4int ny) {
   this->fNy=ny;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetNZ(G4int nz) {
   this->fNz=nz;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetPMTRadius(G4double outerRadius_pmt) {
   this->fOuterRadius_pmt=outerRadius_pmt;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //by Shuya 160509
 void TntDetectorConstruction::SetPMTSizeX(G4double pmt_x) {
   this->fPmt_x=pmt_x;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //by Shuya 160509
 void TntDetectorConstruction::SetPMTSizeY(G4double pmt_y) {
   this->fPmt_y=pmt_y;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -916,8 +1201,7 @@ void TntDetectorConstruction::SetDefaults() {
 	 *  arbitrary scaling).
 	 */	
   if(fTnt_mt) {
-		G4double nphot =  TntGlobalParams::Instance()->GetLightOutput() *
-			TntGlobalParams::Instance()->GetQuantumEfficiency(); // 10400.*0.2;
+		G4double nphot =  TntGlobalParams::Instance()->GetScintillationYield(); // 10400.*0.2;
 		fTnt_mt->AddConstProperty("SCINTILLATIONYIELD", nphot/MeV);
 	}
 //  if(fTnt_mt)fTnt_mt->AddConstProperty("SCINTILLATIONYIELD",(11500.*0.2)/MeV);
@@ -925,58 +1209,62 @@ void TntDetectorConstruction::SetDefaults() {
 
   if(fMPTPStyrene)fMPTPStyrene->AddConstProperty("SCINTILLATIONYIELD",10./keV);
 
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetSphereOn(G4bool b) {
   fSphereOn=b;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetHousingReflectivity(G4double r) {
   fRefl=r;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetWLSSlabOn(G4bool b) {
   fWLSslab=b;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetMainVolumeOn(G4bool b) {
   fMainVolumeOn=b;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetNFibers(G4int n) {
   fNfibers=n;
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
+  GeometryChanged();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntDetectorConstruction::SetMainScintYield(G4double y) {
-  fTnt_mt->AddConstProperty("SCINTILLATIONYIELD",y/MeV);
+  if(fTnt_mt)fTnt_mt->AddConstProperty("SCINTILLATIONYIELD",y/MeV);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
  
 void TntDetectorConstruction::SetWLSScintYield(G4double y) {
-  fMPTPStyrene->AddConstProperty("SCINTILLATIONYIELD",y/MeV);
+  if(fMPTPStyrene)fMPTPStyrene->AddConstProperty("SCINTILLATIONYIELD",y/MeV);
 }
 
-void TntDetectorConstruction::GetDetectorOffset(G4int i, G4double& x, G4double& y)
+void TntDetectorConstruction::GetDetectorOffset(G4int i, G4double& x, G4double& y) const
 {
+	if(fOffsetX.empty() && i == 0) { // single detector, at the origin
+		x = y = 0;
+		return;
+	}
 	try {
 		x = fOffsetX.at(i);
 		y = fOffsetY.at(i);
@@ -985,3 +1273,11 @@ void TntDetectorConstruction::GetDetectorOffset(G4int i, G4double& x, G4double&
 		exit(1);
 	}
 }
+
+G4double TntDetectorConstruction::GetDetectorRadius() const
+{
+	G4double rz = fScint_z/2 + fD_mtl;
+	G4double rxy = fScint_y > 0 ? // box, else cylinder of diameter fScint_x
+		sqrt(pow(fScint_x/2 + fD_mtl, 2) + pow(fScint_y/2 + fD_mtl, 2)) : fScint_x/2 + fD_mtl;
+	return sqrt(rxy*rxy + rz*rz);
+}
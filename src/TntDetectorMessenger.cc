@@ -126,6 +126,17 @@ TntDetectorMessenger::TntDetectorMessenger(TntDetectorConstruction* detector)
   fDefaultsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
   fDefaultsCmd->SetToBeBroadcasted(false);
 
+  fBeginUpdateCmd = new G4UIcommand("/Tnt/detector/beginUpdate",this);
+  fBeginUpdateCmd->SetGuidance("Stage the following geometry changes until endUpdate,");
+  fBeginUpdateCmd->SetGuidance("then rebuild the geometry once.");
+  fBeginUpdateCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fBeginUpdateCmd->SetToBeBroadcasted(false);
+
+  fEndUpdateCmd = new G4UIcommand("/Tnt/detector/endUpdate",this);
+  fEndUpdateCmd->SetGuidance("Apply the geometry changes staged since beginUpdate.");
+  fEndUpdateCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fEndUpdateCmd->SetToBeBroadcasted(false);
+
   fMainScintYield=new G4UIcmdWithADouble("/Tnt/detector/MainScintYield",this);
   fMainScintYield->SetGuidance("Set scinitillation yield of main volume.");
   fMainScintYield->SetGuidance("Specified in photons/MeV");
@@ -152,6 +163,8 @@ TntDetectorMessenger::~TntDetectorMessenger()
   delete fDetectorDir;
   delete fVolumesDir;
   delete fDefaultsCmd;
+  delete fBeginUpdateCmd;
+  delete fEndUpdateCmd;
   delete fSphereCmd;
   delete fWlsCmd;
   delete fLxeCmd;
@@ -187,6 +200,12 @@ void TntDetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
   else if (command == fDefaultsCmd){
     fTntDetector->SetDefaults();
   }
+  else if (command == fBeginUpdateCmd){
+    fTntDetector->BeginUpdate();
+  }
+  else if (command == fEndUpdateCmd){
+    fTntDetector->EndUpdate();
+  }
   else if (command == fSphereCmd){
     fTntDetector->SetSphereOn(fSphereCmd->GetNewBoolValue(newValue));
   }
@@ -36,6 +36,13 @@
 #include "TntTrajectory.hh"
 #include "TntRecorderBase.hh"
 #include "TntGlobalParams.hh"
+#include "TntDetectorConstruction.hh"
+#include "TntLightMap.hh"
+#include "TntRayTraceModel.hh"
+#include "TntScan.hh"
+
+#include <cmath>
+#include <algorithm>
 
 #include "G4EventManager.hh"
 #include "G4SDManager.hh"
@@ -61,7 +68,10 @@ TntEventAction::TntEventAction(TntRecorderBase* r)
   : fRecorder(r),fSaveThreshold(0),fScintCollID(-1),fPMTCollID(-1),fVerbose(1),
 		fPMTThreshold(1),fForcedrawphotons(false),fForcenophotons(false),
 //by Shuya 160407
-		numberOfEvent(-1)
+		numberOfEvent(-1),
+		fLightMapEvents(0),fLightMapExpected(0),fLightMapObserved(0),
+		fLightMapChi2(0),fLightMapNdf(0),
+		fQEEvents(0),fQEHits(0),fQEHits2(0)
 {
   fEventMessenger = new TntEventMessenger(this);
 
@@ -72,7 +82,10 @@ TntEventAction::TntEventAction(TntRecorderBase* r)
  
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-TntEventAction::~TntEventAction(){}
+TntEventAction::~TntEventAction(){
+  if(fLightMapEvents>0) PrintLightMapValidation();
+  if(fQEEvents>0) PrintQESummary();
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -86,7 +99,7 @@ void TntEventAction::BeginOfEventAction(const G4Event* anEvent){
   G4SDManager* SDman = G4SDManager::GetSDMpointer();
   if(fScintCollID<0)
     fScintCollID=SDman->GetCollectionID("scintCollection");
-  if(fPMTCollID<0)
+  if(fPMTCollID<0 && TntGlobalParams::Instance()->GetOpticalPhysics())
     fPMTCollID=SDman->GetCollectionID("pmtHitCollection");
 
   if(fRecorder)fRecorder->RecordBeginOfEvent(anEvent);
@@ -96,6 +109,16 @@ void TntEventAction::BeginOfEventAction(const G4Event* anEvent){
 
 void TntEventAction::EndOfEventAction(const G4Event* anEvent){
 
+  //Photons still queued in a packet of the analytic transport
+  const TntDetectorConstruction* detc = static_cast<const TntDetectorConstruction*>
+    (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  if(detc->GetRayTraceModel()) detc->GetRayTraceModel()->Flush();
+
+  //Calibration events only fill the light map (no data tree output)
+  if(TntGlobalParams::Instance()->GetLightMapBuild()){
+    FillLightMap(anEvent);
+    return;
+  }
 
 //by Shuya 160421
 	extern G4int Counter;
@@ -195,6 +218,8 @@ void TntEventAction::EndOfEventAction(const G4Event* anEvent){
 //by Shuya 160502. I moved these from inside if statement of (pmtHC).
 	G4int pmtphotonfrontsum = 0;
 	G4int pmtphotonbacksum = 0;
+	G4double pmtweightfrontsum = 0;
+	G4double pmtweightbacksum = 0;
 
   if(pmtHC){
     G4ThreeVector reconPos(0.,0.,0.);
@@ -225,6 +250,8 @@ void TntEventAction::EndOfEventAction(const G4Event* anEvent){
 			//by Shuya 160509
 			if(pmtnumber<(npmtX*npmtY))	pmtphotonfrontsum += (*pmtHC)[i]->GetPhotonCount();
 			else if(pmtnumber>=(npmtX*npmtY) && pmtnumber<(2*npmtX*npmtY))	pmtphotonbacksum += (*pmtHC)[i]->GetPhotonCount();
+			if(pmtnumber<(npmtX*npmtY))	pmtweightfrontsum += (*pmtHC)[i]->GetWeightedPhotonCount();
+			else if(pmtnumber>=(npmtX*npmtY) && pmtnumber<(2*npmtX*npmtY))	pmtweightbacksum += (*pmtHC)[i]->GetWeightedPhotonCount();
 			//Comment by Shuya 160428. If you want to check the pmt count, remove the comment out below.
 			//G4cout << pmtnumber << " " << (*pmtHC)[i]->GetPhotonCount() << G4endl;
 
@@ -233,6 +260,7 @@ void TntEventAction::EndOfEventAction(const G4Event* anEvent){
 			//TntDataOutEV->senddataPMT(pmtnumber,(*pmtHC)[i]->GetPhotonCount(),anEvent->GetEventID());
 			//TntDataOutEV->senddataPMT(pmtnumber,(*pmtHC)[i]->GetPhotonCount(),numberOfEvent);
 			TntDataOutEV->senddataPMT(pmtnumber,(*pmtHC)[i]->GetPhotonCount(),Counter);
+			TntDataOutEV->senddataPMT_Weighted(pmtnumber,(*pmtHC)[i]->GetWeightedPhotonCount());
 
 			for(std::vector<G4double>::const_iterator iPhot = (*pmtHC)[i]->GetPhotonTime().begin();
 					iPhot != (*pmtHC)[i]->GetPhotonTime().end(); ++iPhot) {
@@ -265,9 +293,35 @@ void TntEventAction::EndOfEventAction(const G4Event* anEvent){
     pmtHC->DrawAllHits();
   }
 
+	  if((TntGlobalParams::Instance()->GetUseLightMap() &&
+      TntGlobalParams::Instance()->GetLightMapMode()=="validate") ||
+     TntGlobalParams::Instance()->GetOpticalTransport()=="validate")
+    ValidateLightMap(anEvent);
+
+  //Per-point summary of 'beamtype scan'
+  if(TntScan::GetInstance()){
+    TntScan::GetInstance()->Fill(anEvent->GetEventID(),eventInformation->GetLight(),
+                                 eventInformation->GetHitCount(),eventInformation->GetReconPos());
+  }
+
+  if(TntGlobalParams::Instance()->GetQECurve()){
+    ++fQEEvents;
+    fQEHits+=eventInformation->GetHitCount();
+    fQEHits2+=G4double(eventInformation->GetHitCount())*eventInformation->GetHitCount();
+  }
+
 	//by Shuya 160502. I moved these from inside if statement of (pmtHC).
  	TntDataOutEV->senddataEV(7,(double)pmtphotonfrontsum);
  	TntDataOutEV->senddataEV(8,(double)pmtphotonbacksum);
+ 	TntDataOutEV->senddataEV(18,pmtweightfrontsum);
+ 	TntDataOutEV->senddataEV(19,pmtweightbacksum);
+
+	TntDataOutEV->senddataPhotonCuts(eventInformation->GetPhotonTracked(),
+		eventInformation->GetPhotonCutCount(TntUserEventInformation::kCutTime),
+		eventInformation->GetPhotonCutCount(TntUserEventInformation::kCutReflections),
+		eventInformation->GetPhotonCutCount(TntUserEventInformation::kCutPath));
+	TntDataOutEV->senddataFiber(eventInformation->GetFiberCaptured(),
+		eventInformation->GetFiberEndCount(), eventInformation->GetFiberEndTime());
 
 	//by Shuya 160502. NumOfCreatedPhotons are counted in TrackingAction and now sending data to DataRecord.cc, and then initialization
  	TntDataOutEV->senddataEV(9,(double)NumOfCreatedPhotons);
@@ -353,6 +407,133 @@ void TntEventAction::EndOfEventAction(const G4Event* anEvent){
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void TntEventAction::ValidateLightMap(const G4Event* anEvent){
+/*Observed (tracked) photon counts per PMT against the sum of the light map
+	detection probabilities of all photons created in the event, or against
+	the analytic ray-tracing expectation ('optical_transport validate').
+	Poisson chi2 over the PMTs with a non-zero expectation.
+*/
+  TntUserEventInformation* eventInformation
+    =(TntUserEventInformation*)anEvent->GetUserInformation();
+  std::vector<G4double> observed = eventInformation->GetExpectedPMTHits();
+  std::fill(observed.begin(),observed.end(),0.);
+
+  G4HCofThisEvent* hitsCE = anEvent->GetHCofThisEvent();
+  TntPMTHitsCollection* pmtHC = 0;
+  if(hitsCE && fPMTCollID>=0) pmtHC = (TntPMTHitsCollection*)(hitsCE->GetHC(fPMTCollID));
+  G4double observedOutside = 0;
+  if(pmtHC){
+    for(G4int i=0;i<pmtHC->entries();i++){
+      G4int pmtnumber=(*pmtHC)[i]->GetPMTNumber();
+      if(pmtnumber<G4int(observed.size())) observed[pmtnumber]+=(*pmtHC)[i]->GetPhotonCount();
+      else observedOutside+=(*pmtHC)[i]->GetPhotonCount();
+    }
+  }
+
+  const std::vector<G4double>& expected = eventInformation->GetExpectedPMTHits();
+  G4double sumExpected=0, sumObserved=observedOutside, chi2=0;
+  G4int ndf=0;
+  for(size_t i=0;i<expected.size();i++){
+    sumExpected+=expected[i];
+    sumObserved+=observed[i];
+    if(expected[i]>0){
+      chi2+=(observed[i]-expected[i])*(observed[i]-expected[i])/expected[i];
+      ndf++;
+    }
+  }
+  fLightMapEvents++;
+  fLightMapExpected+=sumExpected;
+  fLightMapObserved+=sumObserved;
+  fLightMapChi2+=chi2;
+  fLightMapNdf+=ndf;
+
+  if(fVerbose>0){
+    G4cout << "\t" << (TntGlobalParams::Instance()->GetUseRayTracing() ? "Ray tracing" : "Light map")
+           << " validation: expected " << sumExpected
+           << " PMT hits, observed " << sumObserved
+           << ", chi2/ndf " << chi2 << "/" << ndf << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TntEventAction::FillLightMap(const G4Event* anEvent){
+/*Each event launches photons from one voxel of the map (TntPGALightMap).
+	Detection probability per PMT = photons detected / photons launched, and
+	the time quantiles come from the sorted detection times (photons start
+	at t=0). Events write disjoint voxels, so threads need no lock here.
+*/
+  const TntDetectorConstruction* detc = static_cast<const TntDetectorConstruction*>
+    (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  TntLightMap* lightMap = detc->GetLightMap();
+  G4int nphotons = anEvent->GetNumberOfPrimaryVertex();
+  if(!lightMap || nphotons==0) return;
+  G4int voxel = anEvent->GetEventID() % lightMap->GetNumVoxels();
+  G4int ntq = lightMap->GetNumTimeQuantiles();
+
+  G4HCofThisEvent* hitsCE = anEvent->GetHCofThisEvent();
+  TntPMTHitsCollection* pmtHC = 0;
+  if(hitsCE && fPMTCollID>=0) pmtHC = (TntPMTHitsCollection*)(hitsCE->GetHC(fPMTCollID));
+  if(!pmtHC) return;
+
+  std::vector<G4double> quantiles(ntq);
+  for(G4int i=0;i<pmtHC->entries();i++){
+    G4int pmtnumber=(*pmtHC)[i]->GetPMTNumber();
+    std::vector<G4double> times = (*pmtHC)[i]->GetPhotonTime();
+    if(times.empty() || pmtnumber>=lightMap->GetNumPMTs()) continue;
+    std::sort(times.begin(),times.end());
+    for(G4int iq=0;iq<ntq;iq++){
+      G4double x = iq*(times.size()-1.)/(ntq-1.);
+      size_t j = std::min(size_t(x),times.size()-1);
+      size_t j1 = std::min(j+1,times.size()-1);
+      quantiles[iq] = times[j] + (x-j)*(times[j1]-times[j]);
+    }
+    lightMap->SetEntry(voxel,pmtnumber,G4double(times.size())/nphotons,quantiles);
+  }
+
+  if(fVerbose>0 && anEvent->GetEventID()%100==0){
+    G4cout << "Light map:: voxel " << voxel << ", detection probability "
+           << lightMap->GetDetectionProbability(voxel) << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TntEventAction::PrintLightMapValidation(){
+  G4bool rayTracing = TntGlobalParams::Instance()->GetUseRayTracing();
+  if(rayTracing)
+    G4cout << "================RAY TRACING VALIDATION==================================" << G4endl;
+  else
+    G4cout << "================LIGHT MAP VALIDATION====================================" << G4endl;
+  G4cout << "\tEvents : " << fLightMapEvents << G4endl;
+  G4cout << "\tPMT hits expected from " << (rayTracing ? "ray tracing" : "the map")
+         << " : " << fLightMapExpected << G4endl;
+  G4cout << "\tPMT hits from photon tracking : " << fLightMapObserved << G4endl;
+  if(fLightMapExpected>0){
+    G4cout << "\tObserved/expected : " << fLightMapObserved/fLightMapExpected
+           << " +/- " << std::sqrt(fLightMapObserved)/fLightMapExpected << G4endl;
+  }
+  if(fLightMapNdf>0){
+    G4cout << "\tchi2/ndf (per PMT per event) : " << fLightMapChi2 << "/" << fLightMapNdf
+           << " = " << fLightMapChi2/fLightMapNdf << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TntEventAction::PrintQESummary(){
+  //Compare between a 'qe_mode birth' and a 'qe_mode boundary' run
+  G4double mean=fQEHits/fQEEvents;
+  G4double var=std::max(0.,fQEHits2/fQEEvents-mean*mean);
+  G4cout << "================QE CURVE (qe_mode "
+         << TntGlobalParams::Instance()->GetQEMode() << ")================" << G4endl;
+  G4cout << "	Events : " << fQEEvents << G4endl;
+  G4cout << "	Detected photons per event : " << mean
+         << " +/- " << std::sqrt(var/fQEEvents) << " (rms " << std::sqrt(var) << ")" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void TntEventAction::SetSaveThreshold(G4int save){
 /*Sets the save threshold for the random number seed. If the number of photons
 	generated in an event is lower than this, then save the seed for this event
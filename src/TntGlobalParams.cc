@@ -1,5 +1,9 @@
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 #include "TntGlobalParams.hh"
+#include "TntError.hh"
+#include "TntQECurve.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4PhysicalConstants.hh"
 
@@ -12,10 +16,33 @@ TntGlobalParams::TntGlobalParams(): fNeutronEnergy(1.*MeV),
 																		fNdetY(1),
 																		fBeamType("pencil"),
 																		fReacFile("0"),
+																		fPrimariesIn(""),
+																		fPrimariesOut(""),
+																		fNeutronsPerEvent("one"),
+																		fPrimariesBatch(0),
 																		fInputFile("0"),
 																		fRootFileName("TntDataTree.root"),
 																		fPhotonResolutionScale(1),
 																		fMenateR_Tracking(0),
+																		fMenateR_Sampler("table"),
+																		fMenateR_Validate(0),
+																		fMenateR_Benchmark(false),
+																		fMenateR_Force(false),
+																		fOpticalPhysics(true),
+																		fPhotonThreshold(-1),
+																		fPhotonFraction(1),
+																		fPhotonWindow(-1),
+																		fPhotonWindowMargin(0),
+																		fPhotonMaxReflections(-1),
+																		fPhotonMaxPath(-1),
+																		fLightMapFile(""),
+																		fLightMapMode("fast"),
+																		fLightMapDir("."),
+																		fOpticalTransport("geant4"),
+																		fOpticalPacket(0),
+																		fWLSTransport("geant4"),
+																		fLightMapPhotons(2000),
+																		fLightMapThreads(1),
 																		fScintMaterial("BC404"),
 																		fDetectorX(28.),
 																		fDetectorY(28.),
@@ -23,8 +50,25 @@ TntGlobalParams::TntGlobalParams(): fNeutronEnergy(1.*MeV),
 																		fSourceZ(100.),
 																		fLightOutput(10400),
 																		fQuantumEfficiency(0.2),
-																		fAngerAnalysis("")																	
-{ }
+																		fQECurve(0),
+																		fQEMode("birth"),
+																		fAngerAnalysis(""),
+																		fXSVersion(0),
+																		fXSCompareEvents(10000),
+																		fSweepEvents(10000),
+																		fScanEvents(1),
+																		fScanThreshold(0),
+																		fScanSummary("scan_summary.dat"),
+																		fGeometryEvents(10000),
+																		fGeometryVersion(0)
+{
+	SetLightMapGrid(10, 10, 10);
+	// Default scan: 1 mm (x,z) grid inside the detector, at y = 0
+	SetScanX(-14., 13.9, 0.1);
+	SetScanY(0., 0., 1.);
+	SetScanZ(-5., 4.9, 0.1);
+	SetScanSplit(0, 1);
+}
 
 TntGlobalParams* TntGlobalParams::Instance()
 {
@@ -43,3 +87,196 @@ void TntGlobalParams::SetMenateR_Tracking(G4int n)
 	fMenateR_Tracking = n; 
 	assert(fMenateR_Tracking == 0 || fMenateR_Tracking == 1 || fMenateR_Tracking == 2);
 }
+
+void TntGlobalParams::SetMenateR_Sampler(G4String sampler)
+{
+	fMenateR_Sampler = sampler;
+	assert(fMenateR_Sampler == "table" || fMenateR_Sampler == "analytic");
+}
+
+void TntGlobalParams::SetPhotonFraction(G4double f)
+{
+	fPhotonFraction = f;
+	assert(fPhotonFraction > 0 && fPhotonFraction <= 1);
+}
+
+void TntGlobalParams::SetLightMapMode(G4String mode)
+{
+	fLightMapMode = mode;
+	assert(fLightMapMode == "fast" || fLightMapMode == "full" || fLightMapMode == "validate" ||
+				 fLightMapMode == "build");
+}
+
+void TntGlobalParams::SetOpticalTransport(G4String mode)
+{
+	fOpticalTransport = mode;
+	assert(fOpticalTransport == "geant4" || fOpticalTransport == "analytic" ||
+				 fOpticalTransport == "validate");
+}
+
+void TntGlobalParams::SetOpticalPacket(G4int n)
+{
+	fOpticalPacket = n;
+	assert(fOpticalPacket >= 0 && fOpticalPacket <= 16);
+}
+
+void TntGlobalParams::SetNeutronsPerEvent(G4String mode)
+{
+	fNeutronsPerEvent = mode;
+	assert(fNeutronsPerEvent == "one" || fNeutronsPerEvent == "all");
+}
+
+void TntGlobalParams::SetPrimariesBatch(G4int n)
+{
+	fPrimariesBatch = n;
+	assert(fPrimariesBatch >= 0);
+}
+
+void TntGlobalParams::SetWLSTransport(G4String mode)
+{
+	fWLSTransport = mode;
+	assert(fWLSTransport == "geant4" || fWLSTransport == "param");
+}
+
+void TntGlobalParams::SetQEFile(G4String file)
+{
+	if(!fQECurve) { fQECurve = new TntQECurve(); }
+	if(!fQECurve->Read(file)) {
+		TNTERR << "SetQEFile:: Could not read the QE curve from " << file << G4endl;
+		exit(1);
+	}
+	fQEFile = file;
+}
+
+void TntGlobalParams::SetQEMode(G4String mode)
+{
+	fQEMode = mode;
+	assert(fQEMode == "birth" || fQEMode == "boundary");
+}
+
+G4double TntGlobalParams::GetScintillationYield() const
+{
+	return fQECurve ? fLightOutput : fLightOutput*fQuantumEfficiency;
+}
+
+void TntGlobalParams::SetXSFile(G4String channel, G4String file)
+{
+	fXSFiles[channel] = file;
+	++fXSVersion;
+}
+
+G4String TntGlobalParams::GetXSFile(const G4String& channel, const G4String& defaultFile) const
+{
+	std::map<G4String, G4String>::const_iterator it = fXSFiles.find(channel);
+	return it != fXSFiles.end() ? it->second : defaultFile;
+}
+
+void TntGlobalParams::SetXSFiles(const std::map<G4String, G4String>& files)
+{
+	fXSFiles = files;
+	++fXSVersion;
+}
+
+void TntGlobalParams::AddXSCompare(G4String label, G4String channel, G4String file)
+{
+	if(std::find(fXSCompareLabels.begin(), fXSCompareLabels.end(), label) == fXSCompareLabels.end()) {
+		fXSCompareLabels.push_back(label);
+	}
+	fXSCompareFiles[label][channel] = file;
+}
+
+std::map<G4String, G4String> TntGlobalParams::GetXSCompareFiles(const G4String& label) const
+{
+	std::map<G4String, G4String> files = fXSFiles;
+	std::map<G4String, std::map<G4String, G4String> >::const_iterator it = fXSCompareFiles.find(label);
+	if(it != fXSCompareFiles.end()) {
+		for(std::map<G4String, G4String>::const_iterator itf = it->second.begin(); itf != it->second.end(); ++itf) {
+			files[itf->first] = itf->second;
+		}
+	}
+	return files;
+}
+
+void TntGlobalParams::SetSweepEnergies(std::vector<G4double> energies)
+{
+	fSweepEnergies.clear();
+	for(size_t i=0; i< energies.size(); ++i) {
+		if(energies[i] <= 0) {
+			TNTERR << "SetSweepEnergies:: Invalid energy: " << energies[i] << G4endl;
+			fSweepEnergies.clear();
+			return;
+		}
+		fSweepEnergies.push_back(energies[i]*MeV);
+	}
+}
+
+void TntGlobalParams::SetEnergySweep(G4double emin, G4double emax, G4double step)
+{
+	fSweepEnergies.clear();
+	if(emin <= 0 || step <= 0 || emax < emin) {
+		TNTERR << "SetEnergySweep:: Invalid energy range: " << emin << " " << emax << " " << step << G4endl;
+		return;
+	}
+	for(G4int i=0; emin + i*step <= emax + 1e-9*step; ++i) {
+		fSweepEnergies.push_back((emin + i*step)*MeV);
+	}
+}
+
+void TntGlobalParams::SetSweepEvents(G4int n)
+{
+	fSweepEvents = n;
+	assert(fSweepEvents > 0);
+}
+
+void TntGlobalParams::AddGeometryConfig(G4String label, G4String macro)
+{
+	if(std::find(fGeometryLabels.begin(), fGeometryLabels.end(), label) != fGeometryLabels.end()) {
+		TNTERR << "AddGeometryConfig:: Duplicate configuration label: " << label << G4endl;
+		exit(1);
+	}
+	fGeometryLabels.push_back(label);
+	fGeometryMacros.push_back(macro);
+}
+
+void TntGlobalParams::SetGeometryEvents(G4int n)
+{
+	fGeometryEvents = n;
+	assert(fGeometryEvents > 0);
+}
+
+void TntGlobalParams::SetScanAxis(G4int axis, G4double min, G4double max, G4double step)
+{
+	assert(axis >= 0 && axis < 3);
+	if(step <= 0 || max < min) {
+		TNTERR << "SetScanAxis:: Invalid scan range: " << min << " " << max << " " << step << G4endl;
+		return;
+	}
+	fScanMin[axis] = min*cm;
+	fScanStep[axis] = step*cm;
+	fScanPoints[axis] = G4int(floor((max - min)/step + 1e-6)) + 1;
+}
+
+void TntGlobalParams::SetScanEvents(G4int n)
+{
+	fScanEvents = n;
+	assert(fScanEvents > 0);
+}
+
+void TntGlobalParams::SetScanSplit(G4int job, G4int njobs)
+{
+	fScanSplit[0] = job;
+	fScanSplit[1] = njobs;
+	assert(njobs > 0 && job >= 0 && job < njobs);
+}
+
+void TntGlobalParams::SetXSCompareEnergy(G4double emin, G4double emax, G4double step)
+{
+	fXSCompareEnergies.clear();
+	if(step <= 0 || emax < emin) {
+		TNTERR << "SetXSCompareEnergy:: Invalid energy range: " << emin << " " << emax << " " << step << G4endl;
+		return;
+	}
+	for(G4int i=0; emin + i*step <= emax + 1e-9*step; ++i) {
+		fXSCompareEnergies.push_back((emin + i*step)*MeV);
+	}
+}
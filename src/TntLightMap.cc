@@ -0,0 +1,223 @@
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "TntLightMap.hh"
+#include "TntError.hh"
+#include "G4SystemOfUnits.hh"
+
+namespace {
+const char kLightMapMagic[8] = "TNTLMAP";
+const G4int kLightMapVersion = 2;
+static_assert(sizeof(TntLightMap::Header) == 128, "TntLightMap::Header must be 128 bytes");
+}
+
+TntLightMap::TntLightMap():
+	fShape(kBox), fSize(0,0,0), fNvx(0), fNvy(0), fNvz(0), fNpmt(0), fNtq(0),
+	fGeometryHash(0), fProb(0), fTime(0), fMapAddr(0), fMapSize(0)
+{ }
+
+TntLightMap::~TntLightMap()
+{
+	Clear();
+}
+
+void TntLightMap::Clear()
+{
+	if(fMapAddr) { munmap(fMapAddr, fMapSize); }
+	fMapAddr = 0;
+	fMapSize = 0;
+	fProb = fTime = 0;
+	fProbData.clear();
+	fTimeData.clear();
+}
+
+void TntLightMap::Configure(G4int shape, const G4ThreeVector& size,
+														G4int nvx, G4int nvy, G4int nvz, G4int npmt, G4int ntq)
+{
+	Clear();
+	fShape = shape;
+	fSize = size;
+	fNvx = nvx; fNvy = nvy; fNvz = nvz;
+	fNpmt = npmt;
+	fNtq = std::max(ntq, 2);
+	fProbData.assign(GetNumVoxels()*fNpmt, 0.f);
+	fTimeData.assign(GetNumVoxels()*fNpmt*fNtq, 0.f);
+	fProb = &fProbData[0];
+	fTime = &fTimeData[0];
+	BuildCumulative();
+}
+
+G4bool TntLightMap::Matches(G4int shape, const G4ThreeVector& size, G4int npmt) const
+{
+	return IsLoaded() && shape == fShape && npmt == fNpmt &&
+		(size - fSize).mag() < 1*um;
+}
+
+uint64_t TntLightMap::HashGeometry(const std::string& description)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for(size_t i=0; i< description.size(); ++i) {
+		hash ^= (unsigned char)description[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+G4int TntLightMap::GetVoxel(const G4ThreeVector& localPos) const
+{
+	G4double fx = localPos.x()/fSize.x() + 0.5;
+	G4double fy = localPos.y()/fSize.y() + 0.5;
+	G4double fz = localPos.z()/fSize.z() + 0.5;
+	if(fx < 0 || fx > 1 || fy < 0 || fy > 1 || fz < 0 || fz > 1) {
+		return -1;
+	}
+	// Points on the outer surface belong to the last voxel
+	G4int ix = std::min(G4int(fx*fNvx), fNvx - 1);
+	G4int iy = std::min(G4int(fy*fNvy), fNvy - 1);
+	G4int iz = std::min(G4int(fz*fNvz), fNvz - 1);
+	return (ix*fNvy + iy)*fNvz + iz;
+}
+
+void TntLightMap::GetVoxelBounds(G4int voxel, G4ThreeVector& corner, G4ThreeVector& width) const
+{
+	G4int iz = voxel % fNvz;
+	G4int iy = (voxel / fNvz) % fNvy;
+	G4int ix = voxel / (fNvz*fNvy);
+	width.set(fSize.x()/fNvx, fSize.y()/fNvy, fSize.z()/fNvz);
+	corner.set(-fSize.x()/2 + ix*width.x(),
+						 -fSize.y()/2 + iy*width.y(),
+						 -fSize.z()/2 + iz*width.z());
+}
+
+G4int TntLightMap::SamplePMT(G4int voxel, G4double u) const
+{
+	if(u >= fTotal[voxel]) { return -1; }
+	const float* cum = &fCumProb[voxel*fNpmt];
+	G4int pmt = G4int(std::upper_bound(cum, cum + fNpmt, float(u)) - cum);
+	return std::min(pmt, fNpmt - 1);
+}
+
+G4double TntLightMap::SampleTime(G4int voxel, G4int pmt, G4double u) const
+{
+	const float* q = &fTime[(voxel*fNpmt + pmt)*fNtq];
+	G4double x = u*(fNtq - 1);
+	G4int i = std::min(G4int(x), fNtq - 2);
+	return (q[i] + (x - i)*(q[i+1] - q[i]))*ns;
+}
+
+void TntLightMap::SetEntry(G4int voxel, G4int pmt, G4double prob,
+													 const std::vector<G4double>& timeQuantiles)
+{
+	if(fProbData.empty()) {
+		TNTERR << "TntLightMap::SetEntry:: The map was read from file and is read-only" << G4endl;
+		return;
+	}
+	fProbData[voxel*fNpmt + pmt] = float(prob);
+	float* q = &fTimeData[(voxel*fNpmt + pmt)*fNtq];
+	for(G4int i=0; i< fNtq; ++i) {
+		q[i] = i < G4int(timeQuantiles.size()) ? float(timeQuantiles[i]/ns) : 0.f;
+	}
+	// Keep the per-voxel cumulative sums in step
+	float sum = pmt == 0 ? 0.f : fCumProb[voxel*fNpmt + pmt - 1];
+	for(G4int j=pmt; j< fNpmt; ++j) {
+		sum += fProb[voxel*fNpmt + j];
+		fCumProb[voxel*fNpmt + j] = sum;
+	}
+	fTotal[voxel] = sum;
+}
+
+void TntLightMap::BuildCumulative()
+{
+	fCumProb.assign(GetNumVoxels()*fNpmt, 0.f);
+	fTotal.assign(GetNumVoxels(), 0.f);
+	for(G4int v=0; v< GetNumVoxels(); ++v) {
+		float sum = 0;
+		for(G4int j=0; j< fNpmt; ++j) {
+			sum += fProb[v*fNpmt + j];
+			fCumProb[v*fNpmt + j] = sum;
+		}
+		fTotal[v] = sum;
+	}
+}
+
+G4bool TntLightMap::Write(const G4String& fileName) const
+{
+	if(!IsLoaded()) {
+		TNTERR << "TntLightMap::Write:: Empty map, not writing " << fileName << G4endl;
+		return false;
+	}
+	std::ofstream ofs(fileName.c_str(), std::ios::binary);
+	if(!ofs.good()) {
+		TNTERR << "TntLightMap::Write:: Could not open " << fileName << G4endl;
+		return false;
+	}
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, kLightMapMagic, sizeof(header.magic));
+	header.version = kLightMapVersion;
+	header.shape = fShape;
+	header.geometryHash = fGeometryHash;
+	for(G4int i=0; i< 3; ++i) { header.size[i] = fSize[i]/mm; }
+	header.nvx = fNvx;
+	header.nvy = fNvy;
+	header.nvz = fNvz;
+	header.npmt = fNpmt;
+	header.ntq = fNtq;
+	ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	ofs.write(reinterpret_cast<const char*>(fProb), GetNumVoxels()*fNpmt*sizeof(float));
+	ofs.write(reinterpret_cast<const char*>(fTime), GetNumVoxels()*fNpmt*fNtq*sizeof(float));
+	return ofs.good();
+}
+
+G4bool TntLightMap::Read(const G4String& fileName)
+{
+	Clear();
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if(fd < 0) {
+		TNTERR << "TntLightMap::Read:: Could not open " << fileName << G4endl;
+		return false;
+	}
+	struct stat st;
+	void* addr = MAP_FAILED;
+	if(fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Header)) {
+		addr = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+	if(addr == MAP_FAILED) {
+		TNTERR << "TntLightMap::Read:: Could not map " << fileName << G4endl;
+		return false;
+	}
+	fMapAddr = addr;
+	fMapSize = st.st_size;
+
+	const Header* header = static_cast<const Header*>(addr);
+	if(std::memcmp(header->magic, kLightMapMagic, sizeof(header->magic)) != 0 ||
+		 header->version != kLightMapVersion) {
+		TNTERR << "TntLightMap::Read:: " << fileName << " is not a version "
+					 << kLightMapVersion << " light map, rebuild it with 'lightmap_mode build'" << G4endl;
+		Clear();
+		return false;
+	}
+	if(header->nvx < 1 || header->nvy < 1 || header->nvz < 1 || header->npmt < 1 || header->ntq < 2 ||
+		 fMapSize != sizeof(Header) + size_t(header->nvx)*header->nvy*header->nvz*header->npmt*(1 + header->ntq)*sizeof(float)) {
+		TNTERR << "TntLightMap::Read:: Bad header or truncated file " << fileName << G4endl;
+		Clear();
+		return false;
+	}
+	fShape = header->shape;
+	fSize.set(header->size[0]*mm, header->size[1]*mm, header->size[2]*mm);
+	fNvx = header->nvx; fNvy = header->nvy; fNvz = header->nvz;
+	fNpmt = header->npmt;
+	fNtq = header->ntq;
+	fGeometryHash = header->geometryHash;
+	fProb = reinterpret_cast<const float*>(static_cast<const char*>(addr) + sizeof(Header));
+	fTime = fProb + GetNumVoxels()*fNpmt;
+	BuildCumulative();
+	G4cout << "TntLightMap:: Mapped " << fileName << ": " << fNvx << "x" << fNvy << "x" << fNvz
+				 << " voxels, " << fNpmt << " PMTs, " << fNtq << " time quantiles" << G4endl;
+	return true;
+}
@@ -0,0 +1,81 @@
+#include <string>
+#include "TntLightMapModel.hh"
+#include "TntLightMap.hh"
+#include "TntPMTSD.hh"
+#include "TntGlobalParams.hh"
+#include "TntUserEventInformation.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4SDManager.hh"
+#include "G4EventManager.hh"
+#include "G4VTouchable.hh"
+#include "Randomize.hh"
+
+TntLightMapModel::TntLightMapModel(const G4String& name, G4Region* envelope,
+																	 const TntLightMap* lightMap, G4bool validate):
+	G4VFastSimulationModel(name, envelope),
+	fLightMap(lightMap),
+	fValidate(validate)
+{
+	G4int ndetx, ndety;
+	TntGlobalParams::Instance()->GetNumDetXY(ndetx, ndety);
+	fArray = ndetx > 1 || ndety > 1;
+}
+
+TntLightMapModel::~TntLightMapModel()
+{ }
+
+G4bool TntLightMapModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+	return &particle == G4OpticalPhoton::OpticalPhotonDefinition();
+}
+
+G4bool TntLightMapModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+	// Only photons born in the scintillator, at their first step
+	if(fastTrack.GetPrimaryTrack()->GetCurrentStepNumber() != 1) { return false; }
+	if(!fValidate) { return true; }
+
+	G4int voxel = fLightMap->GetVoxel(fastTrack.GetPrimaryTrackLocalPosition());
+	TntUserEventInformation* eventInformation = (TntUserEventInformation*)
+		G4EventManager::GetEventManager()->GetUserInformation();
+	if(voxel >= 0 && eventInformation) {
+		for(G4int pmt=0; pmt< fLightMap->GetNumPMTs(); ++pmt) {
+			eventInformation->AddExpectedPMTHits(pmt, fLightMap->GetDetectionProbability(voxel, pmt));
+		}
+	}
+	return false;
+}
+
+void TntLightMapModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+	fastStep.KillPrimaryTrack();
+	fastStep.ProposePrimaryTrackPathLength(0.);
+
+	G4int voxel = fLightMap->GetVoxel(fastTrack.GetPrimaryTrackLocalPosition());
+	if(voxel < 0) { return; }
+	G4int pmt = fLightMap->SamplePMT(voxel, G4UniformRand());
+	if(pmt < 0) { return; }
+
+	const G4Track* track = fastTrack.GetPrimaryTrack();
+	TntPMTSD* pmtSD = GetPMTSD(fArray ? track->GetTouchable()->GetCopyNumber() : 0);
+	if(pmtSD) {
+		pmtSD->AddPhotonHit(pmt, track->GetGlobalTime() + fLightMap->SampleTime(voxel, pmt, G4UniformRand()),
+												track->GetWeight());
+	}
+}
+
+TntPMTSD* TntLightMapModel::GetPMTSD(G4int copyNo)
+{
+	if(copyNo < 0) { return 0; }
+	if(size_t(copyNo) >= fPMTSD.size()) { fPMTSD.resize(copyNo+1, 0); }
+	if(!fPMTSD[copyNo]) {
+		// Same SD names as TntDetectorConstruction::ConstructSDandField1/N
+		G4String sdName = "/TntDet/pmtSD";
+		if(fArray) { sdName += std::to_string(copyNo); }
+		fPMTSD[copyNo] = (TntPMTSD*)G4SDManager::GetSDMpointer()->FindSensitiveDetector(sdName, false);
+	}
+	return fPMTSD[copyNo];
+}
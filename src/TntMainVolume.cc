@@ -32,6 +32,8 @@
 #include "globals.hh"
 
 #include "TntMainVolume.hh"
+#include "TntGlobalParams.hh"
+#include "TntQECurve.hh"
 
 #include "G4LogicalSkinSurface.hh"
 #include "G4LogicalBorderSurface.hh"
@@ -396,6 +398,9 @@ void TntMainVolume::VisAttributes(){
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void TntMainVolume::SurfaceProperties(){
+  // Optical surfaces only matter when optical photons are tracked
+  if(!TntGlobalParams::Instance()->GetOpticalPhysics()) return;
+
   G4double ephoton[] = {7.0*eV, 7.14*eV};
   const G4int num = sizeof(ephoton)/sizeof(G4double);
 
@@ -436,7 +441,15 @@ void TntMainVolume::SurfaceProperties(){
   G4double photocath_ImR[]={1.69,1.69};
   assert(sizeof(photocath_ImR) == sizeof(ephoton));
   G4MaterialPropertiesTable* photocath_mt = new G4MaterialPropertiesTable();
-  photocath_mt->AddProperty("EFFICIENCY",ephoton,photocath_EFF,num);
+  const TntQECurve* qeCurve = TntGlobalParams::Instance()->GetQECurve();
+  if(qeCurve && TntGlobalParams::Instance()->GetQEMode()=="boundary"){
+    //Wavelength-dependent detection at the photocathode ('qe_mode boundary')
+    std::vector<G4double> qeEnergy, qe;
+    qeCurve->GetEnergyTable(qeEnergy, qe);
+    photocath_mt->AddProperty("EFFICIENCY",&qeEnergy[0],&qe[0],qeEnergy.size());
+  }
+  else
+    photocath_mt->AddProperty("EFFICIENCY",ephoton,photocath_EFF,num);
   //photocath_mt->AddProperty("REALRINDEX",ephoton,photocath_ReR,num);
   //photocath_mt->AddProperty("IMAGINARYRINDEX",ephoton,photocath_ImR,num);
   //by Shuya 160504. I set photocathodo reflectivity 0 instead of complex calculations using Real and Imaginary R-index above.
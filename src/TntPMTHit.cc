@@ -42,7 +42,7 @@ G4ThreadLocal G4Allocator<TntPMTHit>* TntPMTHitAllocator=0;
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 TntPMTHit::TntPMTHit()
-  : fPmtNumber(-1),fPhotons(0),fPhysVol(0),fDrawit(false) {}
+  : fPmtNumber(-1),fPhotons(0),fWeightedPhotons(0),fPhysVol(0),fDrawit(false) {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -54,6 +54,7 @@ TntPMTHit::TntPMTHit(const TntPMTHit &right) : G4VHit()
 {
   fPmtNumber=right.fPmtNumber;
   fPhotons=right.fPhotons;
+  fWeightedPhotons=right.fWeightedPhotons;
   fPhysVol=right.fPhysVol;
   fDrawit=right.fDrawit;
 }
@@ -63,6 +64,7 @@ TntPMTHit::TntPMTHit(const TntPMTHit &right) : G4VHit()
 const TntPMTHit& TntPMTHit::operator=(const TntPMTHit &right){
   fPmtNumber = right.fPmtNumber;
   fPhotons=right.fPhotons;
+  fWeightedPhotons=right.fWeightedPhotons;
   fPhysVol=right.fPhysVol;
   fDrawit=right.fDrawit;
   return *this;
@@ -116,6 +116,31 @@ G4bool TntPMTSD::ProcessHits_constStep(const G4Step* aStep,
   G4VPhysicalVolume* physVol=
     aStep->GetPostStepPoint()->GetTouchable()->GetVolume(1);
 
+  TntPMTHit* hit = AddPhotonHit(pmtNumber,
+                                aStep->GetPreStepPoint()->GetGlobalTime(),
+                                aStep->GetTrack()->GetWeight(),
+                                physVol);
+
+  if(TntDetectorConstruction::GetSphereOn()){//sphere enabled
+    TntUserTrackInformation* trackInfo=
+      (TntUserTrackInformation*)aStep->GetTrack()->GetUserInformation();
+    if(trackInfo->GetTrackStatus()&hitSphere)
+      //only draw this hit if the photon has hit the sphere first
+      hit->SetDrawit(true);
+  }
+
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+//Adds one detected photon to the hit of PMT pmtNumber, creating the hit if
+//this PMT was not hit before in this event. Also used by TntLightMapModel,
+//which has no step on the photocathode (physVol is then NULL)
+
+TntPMTHit* TntPMTSD::AddPhotonHit(G4int pmtNumber, G4double time,
+                                  G4double weight, G4VPhysicalVolume* physVol){
+
   //Find the correct hit collection
   G4int n=fPMTHitCollection->entries();
   TntPMTHit* hit=NULL;
@@ -140,22 +165,14 @@ G4bool TntPMTSD::ProcessHits_constStep(const G4Step* aStep,
   }
 
   hit->IncPhotonCount(); //increment hit for the selected pmt
-	G4double PhotonTime = aStep->GetPreStepPoint()->GetGlobalTime();
-	hit->AddPhotonTime(PhotonTime);
-	
+  hit->AddPhotonWeight(weight);
+	hit->AddPhotonTime(time);
+
   if(!TntDetectorConstruction::GetSphereOn()){
     hit->SetDrawit(true);
     //If the sphere is disabled then this hit is automaticaly drawn
   }
-  else{//sphere enabled
-    TntUserTrackInformation* trackInfo=
-      (TntUserTrackInformation*)aStep->GetTrack()->GetUserInformation();
-    if(trackInfo->GetTrackStatus()&hitSphere)
-      //only draw this hit if the photon has hit the sphere first
-      hit->SetDrawit(true);
-  }
-
-  return true;
+  return hit;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -39,9 +39,13 @@
 #include "G4OpticalProcessIndex.hh"
 
 #include "G4SystemOfUnits.hh"
+#include "G4FastSimulationManagerProcess.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4ProcessManager.hh"
 
 //by Shuya 160404
 #include "TntNuclearPhysics.hh"
+#include "TntGlobalParams.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -59,20 +63,27 @@ TntPhysicsList::TntPhysicsList() : G4VModularPhysicsList()
   // Muon Physics
   RegisterPhysics( new TntMuonPhysics("muon"));
 
-  // Optical Physics
-  G4OpticalPhysics* opticalPhysics = new G4OpticalPhysics();
-  RegisterPhysics( opticalPhysics );
+  // Optical Physics (left out with 'optical 0': no photons are produced and
+  // only the analytic light output of TntScintSD is recorded)
+  if(TntGlobalParams::Instance()->GetOpticalPhysics()){
+    G4OpticalPhysics* opticalPhysics = new G4OpticalPhysics();
+    RegisterPhysics( opticalPhysics );
 
-  opticalPhysics->SetWLSTimeProfile("delta");
+    opticalPhysics->SetWLSTimeProfile("delta");
 
-  opticalPhysics->SetScintillationYieldFactor(1.0);
-  opticalPhysics->SetScintillationExcitationRatio(0.0);
+    opticalPhysics->SetScintillationYieldFactor(1.0);
+    opticalPhysics->SetScintillationExcitationRatio(0.0);
 
-  opticalPhysics->SetMaxNumPhotonsPerStep(100);
-  opticalPhysics->SetMaxBetaChangePerStep(10.0);
+    opticalPhysics->SetMaxNumPhotonsPerStep(100);
+    opticalPhysics->SetMaxBetaChangePerStep(10.0);
 
-  opticalPhysics->SetTrackSecondariesFirst(kCerenkov,true);
-  opticalPhysics->SetTrackSecondariesFirst(kScintillation,true);
+    // With a photon threshold the photons wait in TntStackingAction until
+    // all other particles are done, so don't suspend their parents
+    G4bool photonsFirst = TntGlobalParams::Instance()->GetPhotonThreshold() < 0 ||
+      TntGlobalParams::Instance()->GetLightMapBuild();
+    opticalPhysics->SetTrackSecondariesFirst(kCerenkov,photonsFirst);
+    opticalPhysics->SetTrackSecondariesFirst(kScintillation,photonsFirst);
+  }
 
 //by Shuya 160404
   AddTransportation();
@@ -99,3 +110,19 @@ void TntPhysicsList::SetCuts(){
   SetCutValue(em_cuts,"e-");
   SetCutValue(em_cuts,"e+");
 }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TntPhysicsList::ConstructProcess(){
+  G4VModularPhysicsList::ConstructProcess();
+
+  if(TntGlobalParams::Instance()->GetUseLightMap() ||
+     TntGlobalParams::Instance()->GetUseRayTracing() ||
+     TntGlobalParams::Instance()->GetUseWLSParam()){
+    G4FastSimulationManagerProcess* fastSimProcess =
+      new G4FastSimulationManagerProcess("fastSimProcess_massGeom");
+    G4ProcessManager* pmanager =
+      G4OpticalPhoton::OpticalPhotonDefinition()->GetProcessManager();
+    pmanager->AddDiscreteProcess(fastSimProcess);
+  }
+}
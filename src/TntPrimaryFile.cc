@@ -0,0 +1,149 @@
+#include <cstring>
+#include <algorithm>
+#include "TntPrimaryFile.hh"
+#include "TntGlobalParams.hh"
+#include "TntError.hh"
+#include "G4AutoLock.hh"
+
+namespace {
+const char kPrimaryFileMagic[8] = "TNTPRIM";
+const G4int kPrimaryFileVersion = 1;
+// Records kept in memory before they are written
+const size_t kWriteBlock = 4096;
+static_assert(sizeof(TntPrimaryFile::Header) == 64, "TntPrimaryFile::Header must be 64 bytes");
+
+TntPrimaryFile* OpenInput()
+{
+	const G4String& fileName = TntGlobalParams::Instance()->GetPrimariesIn();
+	if(fileName.empty()) { return 0; }
+	TntPrimaryFile* file = new TntPrimaryFile();
+	if(!file->OpenRead(fileName)) {
+		G4ExceptionDescription ed;
+		ed << "Cannot read primaries from " << fileName;
+		G4Exception("TntPrimaryFile::GetInput()", "TntPrimaries01", FatalException, ed);
+	}
+	G4cout << "TntPrimaryFile:: Reading " << file->GetNumRecords() << " primaries from "
+				 << fileName << G4endl;
+	return file;
+}
+
+TntPrimaryFile* OpenOutput()
+{
+	const G4String& fileName = TntGlobalParams::Instance()->GetPrimariesOut();
+	if(fileName.empty()) { return 0; }
+	TntPrimaryFile* file = new TntPrimaryFile();
+	if(!file->OpenWrite(fileName)) {
+		G4ExceptionDescription ed;
+		ed << "Cannot create the primaries file " << fileName;
+		G4Exception("TntPrimaryFile::GetOutput()", "TntPrimaries02", FatalException, ed);
+	}
+	return file;
+}
+}
+
+TntPrimaryFile* TntPrimaryFile::GetInput()
+{
+	static TntPrimaryFile* input = OpenInput();
+	return input;
+}
+
+TntPrimaryFile* TntPrimaryFile::GetOutput()
+{
+	static TntPrimaryFile* output = OpenOutput();
+	return output;
+}
+
+TntPrimaryFile::TntPrimaryFile():
+	fWriting(false), fNumRecords(0), fNext(0)
+{
+	G4MUTEXINIT(fMutex);
+}
+
+TntPrimaryFile::~TntPrimaryFile()
+{
+	if(fWriting) { Flush(); }
+}
+
+G4bool TntPrimaryFile::OpenRead(const G4String& fileName)
+{
+	fFileName = fileName;
+	fFile.open(fileName.c_str(), std::ios::in | std::ios::binary);
+	Header header;
+	if(!fFile.read(reinterpret_cast<char*>(&header), sizeof(header))) { return false; }
+	if(strncmp(header.magic, kPrimaryFileMagic, 8) != 0 || header.version != kPrimaryFileVersion ||
+		 header.recordSize != G4int(sizeof(Record))) {
+		TNTERR << "TntPrimaryFile::OpenRead:: " << fileName << " is not a primaries file of version "
+					 << kPrimaryFileVersion << G4endl;
+		return false;
+	}
+	fNumRecords = header.numRecords;
+	fNext = 0;
+	fWriting = false;
+	return fNumRecords > 0;
+}
+
+G4bool TntPrimaryFile::OpenWrite(const G4String& fileName)
+{
+	fFileName = fileName;
+	fFile.open(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	fNumRecords = 0;
+	fWriting = true;
+	fPending.reserve(kWriteBlock);
+	Flush(); // header
+	return fFile.good();
+}
+
+G4int TntPrimaryFile::Read(Record* records, G4int n)
+{
+	G4AutoLock lock(&fMutex);
+	if(fNext == fNumRecords) {
+		G4ExceptionDescription ed;
+		ed << "All " << fNumRecords << " primaries of " << fFileName
+			 << " are used, starting again from the first";
+		G4Exception("TntPrimaryFile::Read()", "TntPrimaries03", JustWarning, ed);
+		fNext = 0;
+	}
+	if(fNext == 0) { fFile.clear(); fFile.seekg(sizeof(Header)); }
+	G4int nread = G4int(std::min(uint64_t(n), fNumRecords - fNext));
+	fFile.read(reinterpret_cast<char*>(records), nread*sizeof(Record));
+	if(!fFile) {
+		G4ExceptionDescription ed;
+		ed << "Error reading " << fFileName << " at record " << fNext;
+		G4Exception("TntPrimaryFile::Read()", "TntPrimaries04", FatalException, ed);
+	}
+	fNext += nread;
+	return nread;
+}
+
+void TntPrimaryFile::Write(const Record& record)
+{
+	G4AutoLock lock(&fMutex);
+	fPending.push_back(record);
+	if(fPending.size() >= kWriteBlock) { WritePending(); }
+}
+
+void TntPrimaryFile::Flush()
+{
+	G4AutoLock lock(&fMutex);
+	if(!fWriting) { return; }
+	WritePending();
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kPrimaryFileMagic, 8);
+	header.version = kPrimaryFileVersion;
+	header.recordSize = sizeof(Record);
+	header.numRecords = fNumRecords;
+	fFile.seekp(0);
+	fFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fFile.seekp(0, std::ios::end);
+	fFile.flush();
+}
+
+void TntPrimaryFile::WritePending()
+{
+	if(fPending.empty()) { return; }
+	fFile.seekp(0, std::ios::end);
+	fFile.write(reinterpret_cast<const char*>(&fPending[0]), fPending.size()*sizeof(Record));
+	fNumRecords += fPending.size();
+	fPending.clear();
+}
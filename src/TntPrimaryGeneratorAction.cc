@@ -30,6 +30,7 @@
 //
 //
 #include <cassert>
+#include <algorithm>
 #include "TntPrimaryGeneratorAction.hh"
 
 #include "G4Event.hh"
@@ -42,7 +43,18 @@
 #include "TntDataRecordTree.hh"
 #include "TntGlobalParams.hh"
 #include "TntInputFileParser.hh"
-
+#include "TntDetectorConstruction.hh"
+#include "TntLightMap.hh"
+#include "TntPrimaryFile.hh"
+
+#include "G4RunManager.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4Material.hh"
+#include "G4MaterialPropertiesTable.hh"
+
+#include "g4gen/Rng.hh"
 #include "g4gen/NeutronDecay.hh"
 #include "g4gen/NuclearMasses.hh"
 #include "g4gen/ReactionGenerator.hh"
@@ -51,7 +63,6 @@
 // need the below for random theta angle source (from Demon)
 #include "Randomize.hh"
 #include "G4UnitsTable.hh"
-extern G4int Counter;
 
 
 
@@ -67,6 +78,11 @@ TntPrimaryGeneratorAction::TntPrimaryGeneratorAction(){
   //BeamType = "diffuse";
   //BeamType = "conic";
 	BeamType = TntGlobalParams::Instance()->GetBeamType();
+	fWhichNeutron = 0;
+	fAllNeutrons = TntGlobalParams::Instance()->GetAllNeutronsInEvent();
+	fBeamProfile.reset(TntBeamProfile::Create(BeamType));
+	fBeamZ = TntBeamProfile::ComputeBeamZ();
+	fGeometryVersion = TntGlobalParams::Instance()->GetGeometryVersion();
 
   G4int n_particle = 1;
   fParticleGun = new G4ParticleGun(n_particle);
@@ -114,155 +130,125 @@ void TntPrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent){
 */
 
 void TntPrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent){
-  //****************************************************
-  // Now select type of beam
-  //****************************************************
-  G4double momentum_x = 0.;   // Default momentum is z-direction for
-  G4double momentum_y = 0.;   // Pencil beams
-  G4double momentum_z = 1.;
-  
-  const G4double Pi = CLHEP::pi;
-
-//by Shuya 160510.
-	G4double detector_thickness = TntGlobalParams::Instance()->GetDetectorZ();
-  G4double beam_z = (-1*TntGlobalParams::Instance()->GetSourceZ() - (detector_thickness/2))*cm;
-	
-//by Shuya 160510
-  //fparticleGun->SetParticlePosition(G4ThreeVector(0.0, 0.0, -5.0*cm));
-  fParticleGun->SetParticlePosition(G4ThreeVector(0.0 , 0.0, beam_z));
-
-  if(BeamType == "pencil")
-    {
-      //position of source of particles
-      //Straight Pencil Beam
-      //particleGun->SetParticlePosition(G4ThreeVector(0.0, 0.0, -25.*cm));
-      //by Shuya 160509
-      fParticleGun->SetParticlePosition(G4ThreeVector(0.0, 0.0, beam_z));
-      //particleGun->SetParticlePosition(G4ThreeVector(0.0, -20.0*cm, 25.*cm));
-      momentum_x = 0.;
-      momentum_y = 0.;
-      momentum_z = 1.;  
-    }
-	else if(BeamType == "rectangle")
-	{
-		momentum_x = 0.;
-		momentum_y = 0.;
-		momentum_z = 1.;
-		G4double posx = G4UniformRand() - 0.5; // -0.5 -> 0.5
-		G4double posy = G4UniformRand() - 0.5; // -0.5 -> 0.5
-		posx *= (TntGlobalParams::Instance()->GetDetectorX()*cm);
-		posy *= (TntGlobalParams::Instance()->GetDetectorX()*cm);
-		fParticleGun->SetParticlePosition(G4ThreeVector(posx, posy, beam_z));
-		// momentum_x = atan(posx/beam_z);
-		// momentum_y = atan(posy/beam_z);
-		// momentum_z = sqrt(1 - pow(momentum_x, 2) - pow(momentum_y, 2));
-		G4ThreeVector v(momentum_x, momentum_y, momentum_z);
-		fParticleGun->SetParticleMomentumDirection(v);
-	}
-	else if(BeamType == "scan")
+	UpdateGeometry();
+	if(!fBeamProfile)
 	{
-		momentum_x = 0.;
-		momentum_y = 0.;
-		momentum_z = 1.;
-		G4int ix = Counter/100;
-		G4int iz = Counter%100;
-		assert(ix<280);
-		assert(iz<100);
-		G4double posx = ix*0.1 - 14.; // cm
-		G4double posz = iz*0.1 - 5.; // cm
-		fParticleGun->SetParticlePosition(G4ThreeVector(posx*cm, 0., posz*cm));
-		G4cout << "GENREATED EVENT:: (x,y) position = " << posx << " mm, " << posz << " mm" << G4endl;
+		G4cerr << "ERROR<TntPrimaryGeneratorAction.cc>:: Invalid BeamType: " << BeamType << G4endl;
+		exit(1);
 	}
-//COMMENT by Shuya 160510. Diffuse beam is parallel beam to z-axis but have random x-y (on theRadius circle) as a source position.
-  else if(BeamType == "diffuse")
-	{
-      // Edited to give a "true" diffuse beam spot - 11/01/08 BTR
-      // Follows method of "BeamPosDet" simulation      
-      //Straight Pencil Beam with a diffuse beam spot. 
-      //Particle starts at a random position
-      //in x-y plane.
-      momentum_x = 0.;
-      momentum_y = 0.;
-      momentum_z = 1.;
-
-      G4double theRadius = 15*cm;
-      theRadius *= 22.5;          // correction factor 
-    
-      // Since diffuse beam is forward focused in small theta,
-      // Need Pi-small number shaped like cosine to get circular beam
-
-     G4double ran = G4UniformRand();
-     G4double theta = acos(1.-0.001*ran);
-
-     ran = G4UniformRand();
-     G4double phi = twopi*ran; // Flat in phi
-
-     G4double x_pos = cos(phi)*sin(theta);
-     G4double y_pos = sin(phi)*sin(theta);
-
-     G4ThreeVector theStartPos(0.,0.,0.);
-      theStartPos[0] = theRadius*x_pos;
-      theStartPos[1] = theRadius*y_pos;
-//by Shuya 160510
-      //theStartPos[2] = -25.*cm;
-      theStartPos[2] = beam_z;
-
-	//by Shuya 160510
-      //particleGun->SetParticlePosition(theStartPos);
-      fParticleGun->SetParticlePosition(theStartPos);
-    }
-  else if(BeamType == "conic")   // Conic source (from Sega1, DEMON sims)
-   {
-
-    // 3D-conic source set x,y,z directions (see Demon for more info)
-    // Convert to "Conic Source" (cone with bottom radius same as detector at front of detector)
-    G4double OpenAngle=180.*deg; 
-    G4double theta;
-    G4double phi;
-    
-//Comment by Shuya 160510... This is inexplicable to me....
-/*
-    //Calculate aperature based on source distance from detector ...
-    G4double dist = 5.0*m;
-    G4double z_pos_det = 25.*cm-10.*cm;  // distance on z-axis-halfheight of module
-    //G4double z_pos_det = 25.*cm-2.5*cm; // Eden test source pos.
-    G4double z_pos = z_pos_det - dist;
-*/
 
-    //by Shuya 160510
-    //fParticleGun->SetParticlePosition(G4ThreeVector(0.0, 0.0, z_pos)); //Default 
-    fParticleGun->SetParticlePosition(G4ThreeVector(0.0, 0.0, beam_z)); //Default 
-    //OpenAngle = atan(8.*cm/dist);
-    //by Shuya 160510. Detector height is 100 cm, so height from z-axis is half of it (50cm).
-    OpenAngle = atan(50.*cm/beam_z);
-
-    theta = acos(1.+(cos(OpenAngle)-1.)*G4UniformRand());
-  
-    phi = 2.*Pi*G4UniformRand(); // flat
-
-    momentum_x = sin(theta)*cos(phi);  // source in z-direction
-    momentum_y = sin(theta)*sin(phi);
-    momentum_z = cos(theta);
-   }
-	else 
+	// Pick up energy changes between runs (e.g. cross-section comparison mode)
+	if(BeamType != "he7" &&
+		 fParticleGun->GetParticleEnergy() != TntGlobalParams::Instance()->GetNeutronEnergy())
 	{
-		G4cerr << "ERROR<TntPrimaryGeneratorAction.cc>:: Invalid BeamType: " << BeamType << G4endl;
-		exit(1);
+		fParticleGun->SetParticleEnergy(TntGlobalParams::Instance()->GetNeutronEnergy());
+		TntDataOutPG->senddataPG(fParticleGun->GetParticleEnergy());
 	}
-	
-  // Set particle direction
-  G4ThreeVector v(momentum_x,momentum_y,momentum_z);
-  
-//by Shuya 160510
-  //fparticleGun->SetParticleMomentumDirection(v);
-  fParticleGun->SetParticleMomentumDirection(v);
+
+	// Position and direction from the beam profile ('beamtype')
+	G4ThreeVector position, direction;
+	fBeamProfile->SetEventID(anEvent->GetEventID());
+	fBeamProfile->Generate(position, direction);
+	fParticleGun->SetParticlePosition(position);
+	fParticleGun->SetParticleMomentumDirection(direction);
 
   fParticleGun->GeneratePrimaryVertex(anEvent);
 
+	// Importance-sampled profiles weight the primary, and so all its secondaries
+	if(fBeamProfile->GetWeight() != 1.) {
+		anEvent->GetPrimaryVertex(anEvent->GetNumberOfPrimaryVertex()-1)->SetWeight(fBeamProfile->GetWeight());
+	}
+	TntDataRecordTree::TntPointer->senddataAcceptance(fBeamProfile->GetWeight());
+
 	TntDataRecordTree::TntPointer->senddataPrimary(fParticleGun->GetParticlePosition(), 
 																								 fParticleGun->GetParticleMomentumDirection());
 }
 
+void TntPrimaryGeneratorAction::UpdateGeometry()
+{
+	// Detector rebuilt between runs (e.g. the geometry sweep of main()) - the
+	// source position and the acceptance cones follow its new dimensions
+	if(fGeometryVersion != TntGlobalParams::Instance()->GetGeometryVersion()) {
+		fBeamProfile.reset(TntBeamProfile::Create(BeamType));
+		fBeamZ = TntBeamProfile::ComputeBeamZ();
+		fGeometryVersion = TntGlobalParams::Instance()->GetGeometryVersion();
+	}
+}
+
+void TntPrimaryGeneratorAction::GenerateNeutron(G4Event* anEvent,
+																								const TntPrimaryFile::Record& record)
+{
+	UpdateGeometry();
+	// Save beam position
+	G4ThreeVector beamPos(record.x, record.y, fBeamZ);
+
+	// Send to data record class
+	fParticleGun->SetParticleEnergy(record.eNeut);
+	TntDataOutPG->senddataPG(fParticleGun->GetParticleEnergy());
+	TntDataOutPG->senddataSecondary(beamPos, G4LorentzVector(record.recoil[0], record.recoil[1],
+																													 record.recoil[2], record.recoil[3]));
+	TntDataOutPG->senddataEjectile(beamPos,
+																 G4LorentzVector(record.ejectile[0], record.ejectile[1],
+																								 record.ejectile[2], record.ejectile[3]),
+																 record.thetaCM);
+	TntDataOutPG->senddataReaction(beamPos,
+																 G4LorentzVector(record.beam[0], record.beam[1],
+																								 record.beam[2], record.beam[3]),
+																 record.targetMass);
+
+	// Set particle gun paramters
+	//
+	// Energy (above) and position
+	fParticleGun->SetParticlePosition(beamPos);
+
+	// Direction
+	G4ThreeVector v(record.dir[0], record.dir[1], record.dir[2]);
+	fParticleGun->SetParticleMomentumDirection(v);
+
+	// Generate event (neutron...), one vertex per neutron so that primary
+	// i is track i+1 (see TntTrackingAction)
+	fParticleGun->GeneratePrimaryVertex(anEvent);
+	TntDataRecordTree::TntPointer->senddataPrimary(fParticleGun->GetParticlePosition(),
+																								 fParticleGun->GetParticleMomentumDirection());
+
+	if(TntPrimaryFile* output = TntPrimaryFile::GetOutput()) { output->Write(record); }
+}
+
+void TntPrimaryGeneratorAction::GenerateReaction(G4Event* anEvent)
+{
+	// Treat n>1 decays as separate 'events' (saved w/ same frag. data)
+	// but neutron data from the corresponding neutron, unless all
+	// neutrons go in the same event ('neutrons_per_event all')
+	//
+	if(fWhichNeutron == 0) {
+		// We are on the first neutron, 
+		// so get a new reaction + decay
+		//
+		G4int batch = TntGlobalParams::Instance()->GetPrimariesBatch();
+		if(batch > 0 && !fSampler) {
+			TntReactionSampler::SampleFunction sample =
+				[this] (std::vector<TntPrimaryFile::Record>& records) { SampleReaction(records); };
+			fSampler.reset(new TntReactionSampler(sample, batch, g4gen::GetRngSeed()));
+		}
+		fReaction.clear();
+		if(fSampler) { fSampler->Next(fReaction); }
+		else         { SampleReaction(fReaction); }
+	}
+
+	do {
+		// Neutron 'fWhichNeutron' and its reaction
+		//
+		const TntPrimaryFile::Record record = fReaction[fWhichNeutron];
+
+		// Iterate through successive neutrons
+		//
+		NextNeutron(fReaction.size());
+
+		// Generate event (neutron...)
+		GenerateNeutron(anEvent, record);
+	} while(fAllNeutrons && fWhichNeutron != 0);
+}
+
 // Utility class to parse reaction files
 //
 namespace { struct reac_file_params {
@@ -288,6 +274,10 @@ namespace { struct reac_file_params {
 	void set_beam_x0(G4double x) { x0=x; }
 	void set_beam_y0(G4double y) { y0=y; }
 }; }
+
+namespace { inline void SetFourVector(double* p, const G4LorentzVector& v) {
+	p[0] = v.px(); p[1] = v.py(); p[2] = v.pz(); p[3] = v.e();
+} }
 	
 	
 
@@ -369,91 +359,52 @@ TntPGAReaction::TntPGAReaction():
 }
 
 TntPGAReaction::~TntPGAReaction()
-{ }
+{
+	fSampler.reset(); // uses fReac and fDecay
+}
 
 void TntPGAReaction::GeneratePrimaries(G4Event* anEvent)
 {
-  //****************************************************
-  // Now select type of beam
-  //****************************************************
-  G4double momentum_x = 0.;   // Default momentum is z-direction for
-  G4double momentum_y = 0.;   // Pencil beams
-  G4double momentum_z = 1.;
-  
-//by Shuya 160510.
-	G4double detector_thickness = TntGlobalParams::Instance()->GetDetectorZ();
-  G4double beam_z = (-1*TntGlobalParams::Instance()->GetSourceZ() - (detector_thickness/2))*cm;
-
-	// Generate event-by-event reaction & neutron decay
-	// Treat n>1 decays as separate 'events' (saved w/ same frag. data)
-	// but neutron data from the corresponding neutron
+	GenerateReaction(anEvent);
+}
+
+void TntPGAReaction::SampleReaction(std::vector<TntPrimaryFile::Record>& records)
+{
+	// Generate a new reaction + decay
 	//
-	int nNeut = fDecay->GetNumberOfNeutrons();
-	static G4int whichNeutron = 0;
-	if(whichNeutron == 0) {
-		// We are on the first neutron, 
-		// so generate a new reaction + decay
-		//
-		G4int ntries = 0;
-		G4bool enoughEnergyForDecay;
-		do {
-			G4bool reacSuccess = fReac->Generate();
-			assert(reacSuccess);
+	G4int ntries = 0;
+	G4bool enoughEnergyForDecay;
+	do {
+		G4bool reacSuccess = fReac->Generate();
+		assert(reacSuccess);
 		
-			// Neutron Decay
-			fDecay->SetInputParticle(&fReac->GetReactant(4));
-			enoughEnergyForDecay = fDecay->Generate();
-			g4gen::CheckMaxTries() (ntries, "TntPgaReaction::GeneratePrimaries");
-		} while(!enoughEnergyForDecay);
-	}
+		// Neutron Decay
+		fDecay->SetInputParticle(&fReac->GetReactant(4));
+		enoughEnergyForDecay = fDecay->Generate();
+		g4gen::CheckMaxTries() (ntries, "TntPgaReaction::GeneratePrimaries");
+	} while(!enoughEnergyForDecay);
 		
-	// Save beam position
-	G4ThreeVector beamPos(fReac->GetReactant(1).PosX(),
-												fReac->GetReactant(1).PosY(),
-												beam_z);
-
-	// Set neutron energy+momentum (for 'whichNeutron')
+	// Each neutron and its reaction
 	// Offset in fDecay->GetFinal() is +2 (initial beam, fragment)
 	//
-	G4double eNeut = fDecay->GetFinal(whichNeutron+2).e() - fDecay->GetFinal(whichNeutron+2).m();
-	momentum_x = fDecay->GetFinal(whichNeutron+2).px();
-	momentum_y = fDecay->GetFinal(whichNeutron+2).py();
-	momentum_z = fDecay->GetFinal(whichNeutron+2).pz();
-
-	// Recoil ('fragment') momentum (4-vector)
-	G4LorentzVector p_recoil = fDecay->GetFinal(1);
-	
-	// Send to data record class
-	TntDataOutPG->senddataPG(fParticleGun->GetParticleEnergy());
-	TntDataOutPG->senddataSecondary(beamPos, p_recoil);
-	TntDataOutPG->senddataEjectile(beamPos,
-																 fReac->GetReactant(3).Momentum(),
-																 fReac->GetThetaCM());
-	TntDataOutPG->senddataReaction(beamPos,
-																 fReac->GetReactant(1).Momentum(),
-																 fReac->GetReactant(2).M());
-
-	
-	// Iterate through successive neutrons
-	//
-	if(whichNeutron == nNeut-1) { whichNeutron = 0; }
-	else                        { ++whichNeutron;		}
-
-
-	// Set particle gun paramters
-	//
-	// Energy and position
-	fParticleGun->SetParticlePosition(beamPos);	
-	fParticleGun->SetParticleEnergy(eNeut);
-
-	// Direction
-  G4ThreeVector v(momentum_x,momentum_y,momentum_z);
-  fParticleGun->SetParticleMomentumDirection(v);
-
-	// Generate event (neutron...)
-  fParticleGun->GeneratePrimaryVertex(anEvent);
-	TntDataRecordTree::TntPointer->senddataPrimary(fParticleGun->GetParticlePosition(), 
-																								 fParticleGun->GetParticleMomentumDirection());
+	int nNeut = fDecay->GetNumberOfNeutrons();
+	for(G4int i=0; i< nNeut; ++i) {
+		TntPrimaryFile::Record record;
+		record.x = fReac->GetReactant(1).PosX();
+		record.y = fReac->GetReactant(1).PosY();
+		record.eNeut = fDecay->GetFinal(i+2).e() - fDecay->GetFinal(i+2).m();
+		record.dir[0] = fDecay->GetFinal(i+2).px();
+		record.dir[1] = fDecay->GetFinal(i+2).py();
+		record.dir[2] = fDecay->GetFinal(i+2).pz();
+		SetFourVector(record.beam, fReac->GetReactant(1).Momentum());
+		SetFourVector(record.ejectile, fReac->GetReactant(3).Momentum());
+		SetFourVector(record.recoil, fDecay->GetFinal(1)); // 'fragment'
+		record.thetaCM = fReac->GetThetaCM();
+		record.targetMass = fReac->GetReactant(2).M();
+		record.neutron = i;
+		record.numNeutrons = nNeut;
+		records.push_back(record);
+	}
 }
 
 
@@ -517,82 +468,148 @@ TntPGAPhaseSpace::TntPGAPhaseSpace(G4int nneut):
 }
 
 TntPGAPhaseSpace::~TntPGAPhaseSpace()
-{ }
+{
+	fSampler.reset(); // uses fReac
+}
 
 void TntPGAPhaseSpace::GeneratePrimaries(G4Event* anEvent)
 {
-  //****************************************************
-  // Now select type of beam
-  //****************************************************
-  G4double momentum_x = 0.;   // Default momentum is z-direction for
-  G4double momentum_y = 0.;   // Pencil beams
-  G4double momentum_z = 1.;
-  
-//by Shuya 160510.
-	G4double detector_thickness = TntGlobalParams::Instance()->GetDetectorZ();
-  G4double beam_z = (-1*TntGlobalParams::Instance()->GetSourceZ() - (detector_thickness/2))*cm;
-
-	// Generate event-by-event reaction w/ phase space neutrons
-	// Treat n>1 decays as separate 'events' (saved w/ same frag. data)
-	// but neutron data from the corresponding neutron
+	GenerateReaction(anEvent);
+}
+
+void TntPGAPhaseSpace::SampleReaction(std::vector<TntPrimaryFile::Record>& records)
+{
+	// Generate a new reaction w/ phase space neutrons
 	//
-	int nNeut = fN;
-	static G4int whichNeutron = 0;
-	if(whichNeutron == 0) {
-		// We are on the first neutron, 
-		// so generate a new reaction + decay
-		//
-		G4bool reacSuccess = fReac->Generate();
-		assert(reacSuccess);
-	}
+	G4bool reacSuccess = fReac->Generate();
+	assert(reacSuccess);
 		
-	// Save beam position
-	G4ThreeVector beamPos(fReac->GetReactant(1).PosX(),
-												fReac->GetReactant(1).PosY(),
-												beam_z);
-
-	// Set neutron energy+momentum (for 'whichNeutron')
+	// Each neutron and its reaction
 	// Offset in fReac->GetReactant is +5
 	// (beam, fragment, ejectile, recoil, and count from ONE)
 	//
 	G4int offset = 5;
-	G4double eNeut = fReac->GetReactant(whichNeutron+offset).Ekin();
-	momentum_x = fReac->GetReactant(whichNeutron+offset).Px();
-	momentum_y = fReac->GetReactant(whichNeutron+offset).Py();
-	momentum_z = fReac->GetReactant(whichNeutron+offset).Pz();
+	for(G4int i=0; i< fN; ++i) {
+		TntPrimaryFile::Record record;
+		record.x = fReac->GetReactant(1).PosX();
+		record.y = fReac->GetReactant(1).PosY();
+		record.eNeut = fReac->GetReactant(i+offset).Ekin();
+		record.dir[0] = fReac->GetReactant(i+offset).Px();
+		record.dir[1] = fReac->GetReactant(i+offset).Py();
+		record.dir[2] = fReac->GetReactant(i+offset).Pz();
+		SetFourVector(record.beam, fReac->GetReactant(1).Momentum());
+		SetFourVector(record.ejectile, fReac->GetReactant(3).Momentum());
+		SetFourVector(record.recoil, fReac->GetReactant(4).Momentum()); // 'fragment'
+		record.thetaCM = fReac->GetThetaCM();
+		record.targetMass = fReac->GetReactant(2).M();
+		record.neutron = i;
+		record.numNeutrons = fN;
+		records.push_back(record);
+	}
+}
 
-	// Recoil ('fragment') momentum (4-vector)
-	G4LorentzVector p_recoil = fReac->GetReactant(4).Momentum();
-	
-	// Send to data record class
-	TntDataOutPG->senddataPG(fParticleGun->GetParticleEnergy());
-	TntDataOutPG->senddataSecondary(beamPos, p_recoil);
-	TntDataOutPG->senddataEjectile(beamPos,
-																 fReac->GetReactant(3).Momentum(),
-																 fReac->GetThetaCM());
-	TntDataOutPG->senddataReaction(beamPos,
-																 fReac->GetReactant(1).Momentum(),
-																 fReac->GetReactant(2).M());
 
-	
-	// Iterate through successive neutrons
-	//
-	if(whichNeutron == nNeut-1) { whichNeutron = 0; }
-	else                        { ++whichNeutron;		}
 
-	
-	// Set particle gun paramters
-	//
-	// Energy and position
-	fParticleGun->SetParticlePosition(beamPos);	
-	fParticleGun->SetParticleEnergy(eNeut);
+// ===================================
+// = TntPGAStream ====================
+// ===================================
 
-	// Direction
-  G4ThreeVector v(momentum_x,momentum_y,momentum_z);
-  fParticleGun->SetParticleMomentumDirection(v);
+TntPGAStream::TntPGAStream():
+	TntPrimaryGeneratorAction(),
+	fInput(TntPrimaryFile::GetInput()),
+	fBuffer(kStreamBlock),
+	fSize(0),
+	fNext(0)
+{ }
 
-	// Generate event (neutron...)
-  fParticleGun->GeneratePrimaryVertex(anEvent);
-	TntDataRecordTree::TntPointer->senddataPrimary(fParticleGun->GetParticlePosition(), 
-																								 fParticleGun->GetParticleMomentumDirection());
+TntPGAStream::~TntPGAStream()
+{ }
+
+void TntPGAStream::GeneratePrimaries(G4Event* anEvent)
+{
+	// With 'neutrons_per_event all', records up to the last neutron of the
+	// reaction go in this event
+	G4bool lastNeutron;
+	do {
+		// Next block of the file for this thread
+		if(fNext == fSize) {
+			fSize = fInput->Read(&fBuffer[0], kStreamBlock);
+			fNext = 0;
+		}
+		const TntPrimaryFile::Record& record = fBuffer[fNext++];
+		lastNeutron = record.neutron+1 >= record.numNeutrons;
+		GenerateNeutron(anEvent, record);
+	} while(fAllNeutrons && !lastNeutron);
+}
+
+
+TntPGALightMap::TntPGALightMap():
+	fNphotons(TntGlobalParams::Instance()->GetLightMapPhotons())
+{
+	// Emission spectrum of the scintillator (trapezoid integral, as in
+	// G4Scintillation)
+	G4MaterialPropertiesTable* mpt = G4Material::GetMaterial("Tnt")->GetMaterialPropertiesTable();
+	G4MaterialPropertyVector* spectrum = mpt ? mpt->GetProperty("FASTCOMPONENT") : 0;
+	if(!spectrum || spectrum->GetVectorLength() < 2) {
+		G4Exception("TntPGALightMap::TntPGALightMap()", "TntLightMap04", FatalException,
+								"No FASTCOMPONENT emission spectrum for the scintillator material");
+	}
+	fEnergy.push_back(spectrum->Energy(0));
+	fCumSpectrum.push_back(0);
+	for(size_t i=1; i< spectrum->GetVectorLength(); ++i) {
+		fEnergy.push_back(spectrum->Energy(i));
+		fCumSpectrum.push_back(fCumSpectrum.back() +
+													 0.5*((*spectrum)[i] + (*spectrum)[i-1])*(fEnergy[i] - fEnergy[i-1]));
+	}
+}
+
+TntPGALightMap::~TntPGALightMap()
+{ }
+
+G4double TntPGALightMap::SampleEnergy() const
+{
+	G4double c = G4UniformRand()*fCumSpectrum.back();
+	size_t i = std::upper_bound(fCumSpectrum.begin(), fCumSpectrum.end(), c) - fCumSpectrum.begin();
+	i = std::min(std::max(i, size_t(1)), fCumSpectrum.size() - 1);
+	G4double f = (c - fCumSpectrum[i-1]) / (fCumSpectrum[i] - fCumSpectrum[i-1]);
+	return fEnergy[i-1] + f*(fEnergy[i] - fEnergy[i-1]);
+}
+
+void TntPGALightMap::GeneratePrimaries(G4Event* anEvent)
+{
+	const TntDetectorConstruction* detc = static_cast<const TntDetectorConstruction*>
+		(G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+	const TntLightMap* lightMap = detc->GetLightMap();
+	G4int voxel = anEvent->GetEventID() % lightMap->GetNumVoxels();
+	G4ThreeVector corner, width;
+	lightMap->GetVoxelBounds(voxel, corner, width);
+	const G4bool cylinder = lightMap->GetShape() == TntLightMap::kCylinder;
+	const G4double radius = lightMap->GetSize().x()/2;
+
+	for(G4int i=0; i< fNphotons; ++i) {
+		G4ThreeVector pos;
+		G4bool inside = false;
+		for(G4int itry=0; itry< 100 && !inside; ++itry) {
+			pos.set(corner.x() + G4UniformRand()*width.x(),
+							corner.y() + G4UniformRand()*width.y(),
+							corner.z() + G4UniformRand()*width.z());
+			inside = !cylinder || pos.perp() < radius;
+		}
+		if(!inside) { break; } // voxel outside the cylinder: no photons
+
+		G4double cost = 1. - 2.*G4UniformRand();
+		G4double sint = sqrt(std::max(0., 1. - cost*cost));
+		G4double phi = CLHEP::twopi*G4UniformRand();
+		G4ThreeVector dir(sint*cos(phi), sint*sin(phi), cost);
+		G4ThreeVector pol = dir.orthogonal().unit();
+		pol.rotate(CLHEP::twopi*G4UniformRand(), dir);
+
+		G4PrimaryParticle* photon = new G4PrimaryParticle(G4OpticalPhoton::OpticalPhotonDefinition());
+		photon->SetMomentumDirection(dir);
+		photon->SetKineticEnergy(SampleEnergy());
+		photon->SetPolarization(pol.x(), pol.y(), pol.z());
+		G4PrimaryVertex* vertex = new G4PrimaryVertex(pos, 0.);
+		vertex->SetPrimary(photon);
+		anEvent->AddPrimaryVertex(vertex);
+	}
 }
@@ -0,0 +1,67 @@
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <utility>
+#include "TntQECurve.hh"
+#include "TntError.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+
+TntQECurve::TntQECurve()
+{ }
+
+G4bool TntQECurve::Read(const G4String& fileName)
+{
+	fWavelength.clear();
+	fQE.clear();
+	std::ifstream ifs(fileName.c_str());
+	if(!ifs.good()) {
+		TNTERR << "TntQECurve::Read:: Could not open " << fileName << G4endl;
+		return false;
+	}
+	std::vector<std::pair<G4double, G4double> > points;
+	std::string line;
+	while(std::getline(ifs, line)) {
+		std::istringstream iss(line);
+		G4double lambda, qe;
+		if(line.empty() || line[0] == '#' || !(iss >> lambda >> qe)) { continue; }
+		if(lambda <= 0 || qe < 0 || qe > 1) {
+			TNTERR << "TntQECurve::Read:: Bad point \"" << line << "\" in " << fileName << G4endl;
+			return false;
+		}
+		points.push_back(std::make_pair(lambda*nm, qe));
+	}
+	if(points.size() < 2) {
+		TNTERR << "TntQECurve::Read:: Need at least two points in " << fileName << G4endl;
+		return false;
+	}
+	std::sort(points.begin(), points.end());
+	for(size_t i=0; i< points.size(); ++i) {
+		fWavelength.push_back(points[i].first);
+		fQE.push_back(points[i].second);
+	}
+	G4cout << "TntQECurve:: Read " << points.size() << " points from " << fileName
+				 << " (" << fWavelength.front()/nm << "-" << fWavelength.back()/nm << " nm)" << G4endl;
+	return true;
+}
+
+G4double TntQECurve::GetQE(G4double photonEnergy) const
+{
+	if(!IsLoaded() || photonEnergy <= 0) { return 0; }
+	const G4double lambda = h_Planck*c_light/photonEnergy;
+	if(lambda < fWavelength.front() || lambda > fWavelength.back()) { return 0; }
+	size_t i = std::upper_bound(fWavelength.begin(), fWavelength.end(), lambda) - fWavelength.begin();
+	if(i == fWavelength.size()) { return fQE.back(); }
+	const G4double t = (lambda - fWavelength[i-1]) / (fWavelength[i] - fWavelength[i-1]);
+	return fQE[i-1] + t*(fQE[i] - fQE[i-1]);
+}
+
+void TntQECurve::GetEnergyTable(std::vector<G4double>& energy, std::vector<G4double>& qe) const
+{
+	energy.clear();
+	qe.clear();
+	for(size_t i = fWavelength.size(); i-- > 0; ) {
+		energy.push_back(h_Planck*c_light/fWavelength[i]);
+		qe.push_back(fQE[i]);
+	}
+}
@@ -0,0 +1,146 @@
+#include <string>
+#include <algorithm>
+#include "TntRayTraceModel.hh"
+#include "TntRayTracer.hh"
+#include "TntPMTSD.hh"
+#include "TntGlobalParams.hh"
+#include "TntUserEventInformation.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4SDManager.hh"
+#include "G4EventManager.hh"
+#include "G4VTouchable.hh"
+
+namespace {
+// Traces per photon in validate mode
+const G4int kValidateTraces = 10;
+}
+
+TntRayTraceModel::TntRayTraceModel(const G4String& name, G4Region* envelope,
+																	 const TntRayTracer* rayTracer, G4bool validate,
+																	 G4int packetSize):
+	G4VFastSimulationModel(name, envelope),
+	fRayTracer(rayTracer),
+	fValidate(validate),
+	fPacketSize(std::min(packetSize, G4int(TntRayTracer::kMaxPacket)))
+{
+	fPacket.size = 0;
+	G4int ndetx, ndety;
+	TntGlobalParams::Instance()->GetNumDetXY(ndetx, ndety);
+	fArray = ndetx > 1 || ndety > 1;
+}
+
+TntRayTraceModel::~TntRayTraceModel()
+{ }
+
+G4bool TntRayTraceModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+	return &particle == G4OpticalPhoton::OpticalPhotonDefinition();
+}
+
+G4bool TntRayTraceModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+	// Only photons born in the scintillator, at their first step
+	if(fastTrack.GetPrimaryTrack()->GetCurrentStepNumber() != 1) { return false; }
+	if(!fValidate) { return true; }
+
+	TntUserEventInformation* eventInformation = (TntUserEventInformation*)
+		G4EventManager::GetEventManager()->GetUserInformation();
+	if(!eventInformation) { return false; }
+	const G4Track* track = fastTrack.GetPrimaryTrack();
+	TntRayTracer::Result result;
+	for(G4int i=0; i< kValidateTraces; ++i) {
+		fRayTracer->Trace(fastTrack.GetPrimaryTrackLocalPosition(),
+											fastTrack.GetPrimaryTrackLocalDirection(),
+											track->GetKineticEnergy(), track->GetGlobalTime(), result);
+		if(result.status == TntRayTracer::kDetected) {
+			eventInformation->AddExpectedPMTHits(result.pmt, 1./kValidateTraces);
+		}
+	}
+	return false;
+}
+
+void TntRayTraceModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+	const G4Track* track = fastTrack.GetPrimaryTrack();
+	fastStep.KillPrimaryTrack();
+
+	if(fPacketSize > 1) {
+		// Queue the photon; its fate is recorded when the packet is traced
+		fastStep.ProposePrimaryTrackPathLength(0.);
+		const G4ThreeVector& pos = fastTrack.GetPrimaryTrackLocalPosition();
+		const G4ThreeVector& dir = fastTrack.GetPrimaryTrackLocalDirection();
+		G4int i = fPacket.size++;
+		fPacket.x[i] = pos.x();  fPacket.y[i] = pos.y();  fPacket.z[i] = pos.z();
+		fPacket.dx[i] = dir.x(); fPacket.dy[i] = dir.y(); fPacket.dz[i] = dir.z();
+		fPacket.energy[i] = track->GetKineticEnergy();
+		fPacket.time[i] = track->GetGlobalTime();
+		fWeight[i] = track->GetWeight();
+		fCopyNo[i] = track->GetTouchable()->GetCopyNumber();
+		if(fPacket.size == fPacketSize) { Flush(); }
+		return;
+	}
+
+	TntRayTracer::Result result;
+	fRayTracer->Trace(fastTrack.GetPrimaryTrackLocalPosition(),
+										fastTrack.GetPrimaryTrackLocalDirection(),
+										track->GetKineticEnergy(), track->GetGlobalTime(), result);
+	fastStep.ProposePrimaryTrackPathLength(result.path);
+	fastStep.ProposePrimaryTrackFinalTime(result.time);
+	Record(result, track->GetWeight(), track->GetTouchable()->GetCopyNumber());
+}
+
+void TntRayTraceModel::Flush()
+{
+	if(fPacket.size == 0) { return; }
+	TntRayTracer::Result results[TntRayTracer::kMaxPacket];
+	fRayTracer->TracePacket(fPacket, results);
+	for(G4int i=0; i< fPacket.size; ++i) {
+		Record(results[i], fWeight[i], fCopyNo[i]);
+	}
+	fPacket.size = 0;
+}
+
+void TntRayTraceModel::Record(const TntRayTracer::Result& result, G4double weight, G4int copyNo)
+{
+	// Same bookkeeping as TntSteppingAction for tracked photons
+	TntUserEventInformation* eventInformation = (TntUserEventInformation*)
+		G4EventManager::GetEventManager()->GetUserInformation();
+	if(eventInformation) {
+		switch(result.status) {
+		case TntRayTracer::kBulkAbsorbed:
+			eventInformation->IncAbsorption(); break;
+		case TntRayTracer::kSurfaceAbsorbed:
+			eventInformation->IncBoundaryAbsorption(); break;
+		case TntRayTracer::kCutTime:
+			eventInformation->IncPhotonCut(TntUserEventInformation::kCutTime); break;
+		case TntRayTracer::kCutReflections:
+			eventInformation->IncPhotonCut(TntUserEventInformation::kCutReflections); break;
+		case TntRayTracer::kCutPath:
+			eventInformation->IncPhotonCut(TntUserEventInformation::kCutPath); break;
+		default:
+			break;
+		}
+	}
+	if(result.status != TntRayTracer::kDetected) { return; }
+
+	TntPMTSD* pmtSD = GetPMTSD(fArray ? copyNo : 0);
+	if(pmtSD) {
+		pmtSD->AddPhotonHit(result.pmt, result.time, weight);
+	}
+}
+
+TntPMTSD* TntRayTraceModel::GetPMTSD(G4int copyNo)
+{
+	if(copyNo < 0) { return 0; }
+	if(size_t(copyNo) >= fPMTSD.size()) { fPMTSD.resize(copyNo+1, 0); }
+	if(!fPMTSD[copyNo]) {
+		// Same SD names as TntDetectorConstruction::ConstructSDandField1/N
+		G4String sdName = "/TntDet/pmtSD";
+		if(fArray) { sdName += std::to_string(copyNo); }
+		fPMTSD[copyNo] = (TntPMTSD*)G4SDManager::GetSDMpointer()->FindSensitiveDetector(sdName, false);
+	}
+	return fPMTSD[copyNo];
+}
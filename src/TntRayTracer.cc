@@ -0,0 +1,333 @@
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "TntRayTracer.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+namespace {
+// Reflection limit when 'photon_maxrefl' is off, so that a photon bouncing
+// in a lossless cell cannot loop forever
+const G4int kMaxReflections = 100000;
+}
+
+TntRayTracer::TntRayTracer():
+	fShape(kBox), fHalf(0,0,0), fNumPMTs(0),
+	fAbsLength(0), fGroupVel(0), fRindex(0), fReflectivity(0), fEfficiency(0),
+	fTimeCut(-1), fMaxReflections(-1), fMaxPath(-1)
+{ }
+
+TntRayTracer::~TntRayTracer()
+{ }
+
+void TntRayTracer::SetBox(const G4ThreeVector& size)
+{
+	fShape = kBox;
+	fHalf = size/2.;
+}
+
+void TntRayTracer::SetCylinder(G4double diameter, G4double length)
+{
+	fShape = kCylinder;
+	fHalf.set(diameter/2., diameter/2., length/2.);
+}
+
+void TntRayTracer::SetPMTs(const std::vector<G4ThreeVector>& positions, G4double sizeX, G4double sizeY)
+{
+	/** The PMT placements of TntMainVolume rotate the local x/y of the PMT box
+	 *  onto these face coordinates: front/back (x,y); left/right (y,z) with the
+	 *  local x along z; bottom/top (x,z) with the local y along z.
+	 */
+	for(G4int f=0; f< 6; ++f) { fWindows[f].clear(); }
+	fNumPMTs = positions.size();
+	for(G4int k=0; k< fNumPMTs; ++k) {
+		const G4ThreeVector& c = positions[k];
+		Window w;
+		w.pmt = k;
+		G4int face;
+		if(std::fabs(c.z()) > fHalf.z()) {
+			face = c.z() < 0 ? 0 : 1;
+			w.u0 = c.x() - sizeX/2.; w.u1 = c.x() + sizeX/2.;
+			w.v0 = c.y() - sizeY/2.; w.v1 = c.y() + sizeY/2.;
+		}
+		else if(std::fabs(c.x()) > fHalf.x()) {
+			face = c.x() < 0 ? 2 : 3;
+			w.u0 = c.y() - sizeY/2.; w.u1 = c.y() + sizeY/2.;
+			w.v0 = c.z() - sizeX/2.; w.v1 = c.z() + sizeX/2.;
+		}
+		else {
+			face = c.y() < 0 ? 4 : 5;
+			w.u0 = c.x() - sizeX/2.; w.u1 = c.x() + sizeX/2.;
+			w.v0 = c.z() - sizeY/2.; w.v1 = c.z() + sizeY/2.;
+		}
+		fWindows[face].push_back(w);
+	}
+}
+
+G4bool TntRayTracer::SetOptics(G4MaterialPropertiesTable* scint,
+															 G4MaterialPropertiesTable* housing,
+															 G4MaterialPropertiesTable* photocathode)
+{
+	if(!scint || !housing || !photocathode) { return false; }
+	fAbsLength = scint->GetProperty("ABSLENGTH");
+	fRindex = scint->GetProperty("RINDEX");
+	fGroupVel = scint->GetProperty("GROUPVEL");
+	fReflectivity = housing->GetProperty("REFLECTIVITY");
+	fEfficiency = photocathode->GetProperty("EFFICIENCY");
+	return (fGroupVel || fRindex) && fReflectivity && fEfficiency;
+}
+
+G4double TntRayTracer::DistanceToOut(const G4ThreeVector& pos, const G4ThreeVector& dir, G4int& face) const
+{
+	G4double dist = DBL_MAX;
+	face = -1;
+	// planes (all six for a box, the end caps for a cylinder)
+	const G4int axis[3] = { 2, 0, 1 }; // faces 0/1, 2/3, 4/5
+	const G4int nplanes = fShape == kBox ? 3 : 1;
+	for(G4int i=0; i< nplanes; ++i) {
+		G4int a = axis[i];
+		if(dir[a] == 0) { continue; }
+		G4double s = ((dir[a] > 0 ? fHalf[a] : -fHalf[a]) - pos[a])/dir[a];
+		if(s < dist) { dist = s; face = 2*i + (dir[a] > 0 ? 1 : 0); }
+	}
+	if(fShape == kCylinder) {
+		G4double a = dir.x()*dir.x() + dir.y()*dir.y();
+		if(a > 0) {
+			G4double b = pos.x()*dir.x() + pos.y()*dir.y();
+			G4double c = pos.x()*pos.x() + pos.y()*pos.y() - fHalf.x()*fHalf.x();
+			G4double s = (-b + std::sqrt(std::max(0., b*b - a*c)))/a;
+			if(s < dist) { dist = s; face = 6; }
+		}
+	}
+	return std::max(dist, 0.);
+}
+
+G4ThreeVector TntRayTracer::Normal(const G4ThreeVector& pos, G4int face) const
+{
+	switch(face) {
+	case 0: return G4ThreeVector(0, 0, -1);
+	case 1: return G4ThreeVector(0, 0,  1);
+	case 2: return G4ThreeVector(-1, 0, 0);
+	case 3: return G4ThreeVector( 1, 0, 0);
+	case 4: return G4ThreeVector(0, -1, 0);
+	case 5: return G4ThreeVector(0,  1, 0);
+	default: return G4ThreeVector(pos.x(), pos.y(), 0).unit();
+	}
+}
+
+G4int TntRayTracer::FindPMT(const G4ThreeVector& pos, G4int face) const
+{
+	if(face > 5) { return -1; }
+	G4double u, v;
+	if(face < 2)      { u = pos.x(); v = pos.y(); }
+	else if(face < 4) { u = pos.y(); v = pos.z(); }
+	else              { u = pos.x(); v = pos.z(); }
+	const std::vector<Window>& windows = fWindows[face];
+	for(size_t i=0; i< windows.size(); ++i) {
+		const Window& w = windows[i];
+		if(u >= w.u0 && u <= w.u1 && v >= w.v0 && v <= w.v1) { return w.pmt; }
+	}
+	return -1;
+}
+
+void TntRayTracer::Trace(const G4ThreeVector& pos, const G4ThreeVector& dir,
+												 G4double energy, G4double time, Result& result) const
+{
+	result.pmt = -1;
+	result.time = time;
+	result.path = 0;
+	result.reflections = 0;
+
+	const G4double absLength = fAbsLength ? fAbsLength->Value(energy) : DBL_MAX;
+	const G4double speed = fGroupVel ? fGroupVel->Value(energy) : c_light/fRindex->Value(energy);
+	const G4double reflectivity = fReflectivity->Value(energy);
+	const G4double efficiency = fEfficiency->Value(energy);
+	const G4int maxReflections = fMaxReflections >= 0 ? fMaxReflections : kMaxReflections;
+
+	// Path length at which the photon is absorbed in the bulk
+	const G4double absPath = -absLength*std::log(1. - G4UniformRand());
+
+	G4ThreeVector p = pos;
+	G4ThreeVector d = dir.unit();
+	for(;;) {
+		G4int face;
+		G4double s = DistanceToOut(p, d, face);
+		if(result.path + s >= absPath) {
+			s = absPath - result.path;
+			result.path = absPath;
+			result.time += s/speed;
+			result.status = kBulkAbsorbed;
+			return;
+		}
+		p += s*d;
+		result.path += s;
+		result.time += s/speed;
+
+		// Photocathode (REFLECTIVITY 0) or housing surface, as in
+		// G4OpBoundaryProcess::DielectricMetal
+		result.pmt = FindPMT(p, face);
+		if(result.pmt >= 0) {
+			if(G4UniformRand() < efficiency) {
+				result.status = kDetected;
+			} else {
+				result.pmt = -1;
+				result.status = kSurfaceAbsorbed;
+			}
+			return;
+		}
+		if(G4UniformRand() >= reflectivity) {
+			result.status = kSurfaceAbsorbed;
+			return;
+		}
+		G4ThreeVector n = Normal(p, face);
+		d -= 2.*d.dot(n)*n;
+		++result.reflections;
+
+		// Same order as the cutoffs in TntSteppingAction
+		if(fTimeCut >= 0 && result.time > fTimeCut) {
+			result.status = kCutTime;
+			return;
+		}
+		if(result.reflections > maxReflections) {
+			result.status = fMaxReflections >= 0 ? kCutReflections : kLoopLimit;
+			return;
+		}
+		if(fMaxPath >= 0 && result.path > fMaxPath) {
+			result.status = kCutPath;
+			return;
+		}
+	}
+}
+
+void TntRayTracer::TracePacket(const Packet& packet, Result* results) const
+{
+	/** Live photons are kept packed at the front of the lane arrays (lane ->
+	 *  photon in idx), so every pass works on, and draws random numbers for,
+	 *  the live photons only.
+	 */
+	const G4int maxReflections = fMaxReflections >= 0 ? fMaxReflections : kMaxReflections;
+	const G4int reflStatus = fMaxReflections >= 0 ? kCutReflections : kLoopLimit;
+	const G4double timeCut = fTimeCut >= 0 ? fTimeCut : DBL_MAX;
+	const G4double maxPath = fMaxPath >= 0 ? fMaxPath : DBL_MAX;
+	const G4double hx = fHalf.x(), hy = fHalf.y(), hz = fHalf.z();
+	const G4bool box = fShape == kBox;
+
+	G4double px[kMaxPacket], py[kMaxPacket], pz[kMaxPacket];
+	G4double dx[kMaxPacket], dy[kMaxPacket], dz[kMaxPacket];
+	G4double t[kMaxPacket], path[kMaxPacket], absPath[kMaxPacket], speed[kMaxPacket];
+	G4double reflectivity[kMaxPacket], efficiency[kMaxPacket];
+	G4double s[kMaxPacket], u[kMaxPacket];
+	G4int face[kMaxPacket], nrefl[kMaxPacket], status[kMaxPacket], idx[kMaxPacket];
+
+	G4int n = std::min(packet.size, G4int(kMaxPacket));
+	G4Random::getTheEngine()->flatArray(n, u);
+	for(G4int i=0; i< n; ++i) {
+		// property tables are looked up photon by photon
+		const G4double e = packet.energy[i];
+		speed[i] = fGroupVel ? fGroupVel->Value(e) : c_light/fRindex->Value(e);
+		absPath[i] = fAbsLength ? -fAbsLength->Value(e)*std::log(u[i]) : DBL_MAX;
+		reflectivity[i] = fReflectivity->Value(e);
+		efficiency[i] = fEfficiency->Value(e);
+		px[i] = packet.x[i];  py[i] = packet.y[i];  pz[i] = packet.z[i];
+		dx[i] = packet.dx[i]; dy[i] = packet.dy[i]; dz[i] = packet.dz[i];
+		t[i] = packet.time[i];
+		path[i] = 0;
+		nrefl[i] = 0;
+		idx[i] = i;
+		results[i].pmt = -1;
+	}
+
+	while(n > 0) {
+		// Distance to the surface along the current direction
+		for(G4int i=0; i< n; ++i) {
+			G4double sz = dz[i] != 0 ? ((dz[i] > 0 ? hz : -hz) - pz[i])/dz[i] : DBL_MAX;
+			G4double sx = DBL_MAX, sy = DBL_MAX, sr = DBL_MAX;
+			if(box) {
+				sx = dx[i] != 0 ? ((dx[i] > 0 ? hx : -hx) - px[i])/dx[i] : DBL_MAX;
+				sy = dy[i] != 0 ? ((dy[i] > 0 ? hy : -hy) - py[i])/dy[i] : DBL_MAX;
+			} else {
+				G4double a = dx[i]*dx[i] + dy[i]*dy[i];
+				G4double b = px[i]*dx[i] + py[i]*dy[i];
+				G4double c = px[i]*px[i] + py[i]*py[i] - hx*hx;
+				sr = a > 0 ? (-b + std::sqrt(std::max(0., b*b - a*c)))/a : DBL_MAX;
+			}
+			G4int f = dz[i] > 0 ? 1 : 0;
+			G4double smin = sz;
+			if(sx < smin) { smin = sx; f = dx[i] > 0 ? 3 : 2; }
+			if(sy < smin) { smin = sy; f = dy[i] > 0 ? 5 : 4; }
+			if(sr < smin) { smin = sr; f = 6; }
+			s[i] = std::max(smin, 0.);
+			face[i] = f;
+		}
+
+		// Move to the surface, or to the absorption point
+		for(G4int i=0; i< n; ++i) {
+			G4bool absorbed = path[i] + s[i] >= absPath[i];
+			G4double step = absorbed ? absPath[i] - path[i] : s[i];
+			px[i] += step*dx[i]; py[i] += step*dy[i]; pz[i] += step*dz[i];
+			path[i] += step;
+			t[i] += step/speed[i];
+			status[i] = absorbed ? kBulkAbsorbed : -1;
+		}
+
+		// Photocathode or housing; specular reflection and cutoffs of the rest
+		G4Random::getTheEngine()->flatArray(n, u);
+		for(G4int i=0; i< n; ++i) {
+			if(status[i] >= 0) { continue; }
+			G4int pmt = FindPMT(G4ThreeVector(px[i], py[i], pz[i]), face[i]);
+			if(pmt >= 0) {
+				G4bool detected = u[i] < efficiency[i];
+				results[idx[i]].pmt = detected ? pmt : -1;
+				status[i] = detected ? kDetected : kSurfaceAbsorbed;
+				continue;
+			}
+			if(u[i] >= reflectivity[i]) {
+				status[i] = kSurfaceAbsorbed;
+				continue;
+			}
+			G4double nx = 0, ny = 0, nz = 0;
+			switch(face[i]) {
+			case 0: nz = -1; break;
+			case 1: nz =  1; break;
+			case 2: nx = -1; break;
+			case 3: nx =  1; break;
+			case 4: ny = -1; break;
+			case 5: ny =  1; break;
+			default: {
+				G4double r = std::sqrt(px[i]*px[i] + py[i]*py[i]);
+				nx = px[i]/r; ny = py[i]/r;
+			}
+			}
+			G4double dn = 2.*(dx[i]*nx + dy[i]*ny + dz[i]*nz);
+			dx[i] -= dn*nx; dy[i] -= dn*ny; dz[i] -= dn*nz;
+			++nrefl[i];
+			// same order as the cutoffs in TntSteppingAction
+			if(t[i] > timeCut)                 { status[i] = kCutTime; }
+			else if(nrefl[i] > maxReflections) { status[i] = reflStatus; }
+			else if(path[i] > maxPath)         { status[i] = kCutPath; }
+		}
+
+		// Store the finished photons and pack the live ones
+		G4int m = 0;
+		for(G4int i=0; i< n; ++i) {
+			if(status[i] >= 0) {
+				Result& result = results[idx[i]];
+				result.status = status[i];
+				result.time = t[i];
+				result.path = path[i];
+				result.reflections = nrefl[i];
+				continue;
+			}
+			if(m != i) {
+				px[m] = px[i]; py[m] = py[i]; pz[m] = pz[i];
+				dx[m] = dx[i]; dy[m] = dy[i]; dz[m] = dz[i];
+				t[m] = t[i]; path[m] = path[i]; absPath[m] = absPath[i]; speed[m] = speed[i];
+				reflectivity[m] = reflectivity[i]; efficiency[m] = efficiency[i];
+				nrefl[m] = nrefl[i]; idx[m] = idx[i];
+			}
+			++m;
+		}
+		n = m;
+	}
+}
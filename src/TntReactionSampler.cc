@@ -0,0 +1,81 @@
+#include "TntReactionSampler.hh"
+#include "g4gen/Rng.hh"
+
+TntReactionSampler::TntReactionSampler(const SampleFunction& sample, G4int batchSize, uint64_t seed):
+	fSample(sample),
+	fBatchSize(batchSize),
+	fSeed(seed),
+	fConsume(0),
+	fNext(0),
+	fStop(false)
+{
+	for(G4int i=0; i< kNumBatches; ++i) { fBatches[i].full = false; }
+	fThread = std::thread(&TntReactionSampler::Produce, this);
+}
+
+TntReactionSampler::~TntReactionSampler()
+{
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		fStop = true;
+	}
+	fCondition.notify_all();
+	fThread.join();
+}
+
+G4int TntReactionSampler::BatchSeed(uint64_t seed, uint64_t batch)
+{
+	uint64_t z = seed + (batch + 1)*0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+	z ^= z >> 31;
+	return G4int(z % 0x7ffffffeULL) + 1;
+}
+
+void TntReactionSampler::Produce()
+{
+	for(uint64_t batch = 0; ; ++batch) {
+		Batch& b = fBatches[batch % kNumBatches];
+		{
+			std::unique_lock<std::mutex> lock(fMutex);
+			fCondition.wait(lock, [&] { return fStop || !b.full; });
+			if(fStop) { return; }
+		}
+
+		// Not full: Next() does not touch it until it is marked full below
+		g4gen::SetRngSeed(BatchSeed(fSeed, batch));
+		b.records.clear();
+		for(G4int i=0; i< fBatchSize; ++i) { fSample(b.records); }
+
+		{
+			std::lock_guard<std::mutex> lock(fMutex);
+			b.full = true;
+		}
+		fCondition.notify_all();
+	}
+}
+
+void TntReactionSampler::Next(std::vector<TntPrimaryFile::Record>& records)
+{
+	Batch& b = fBatches[fConsume];
+	if(fNext == 0) {
+		std::unique_lock<std::mutex> lock(fMutex);
+		fCondition.wait(lock, [&] { return b.full; });
+	}
+
+	// One record per neutron of the reaction
+	G4int nNeut = b.records[fNext].numNeutrons;
+	records.insert(records.end(), b.records.begin() + fNext, b.records.begin() + fNext + nNeut);
+	fNext += nNeut;
+
+	// Batch used up: hand it back to the producer
+	if(fNext == b.records.size()) {
+		{
+			std::lock_guard<std::mutex> lock(fMutex);
+			b.full = false;
+		}
+		fCondition.notify_all();
+		fConsume = (fConsume + 1) % kNumBatches;
+		fNext = 0;
+	}
+}
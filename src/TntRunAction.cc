@@ -31,6 +31,9 @@
 //
 #include "TntRunAction.hh"
 #include "TntRecorderBase.hh"
+#include "TntPrimaryFile.hh"
+#include "TntScan.hh"
+#include "TntGlobalParams.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -51,4 +54,9 @@ void TntRunAction::BeginOfRunAction(const G4Run* aRun){
 
 void TntRunAction::EndOfRunAction(const G4Run* aRun){
   if(fRecorder)fRecorder->RecordEndOfRun(aRun);
+  //Complete the 'primaries_out' file after each run
+  if(IsMaster() && TntPrimaryFile::GetOutput())TntPrimaryFile::GetOutput()->Flush();
+  //Per-point summary of 'beamtype scan', rewritten after each run
+  if(IsMaster() && TntScan::GetInstance())
+    TntScan::GetInstance()->Write(TntGlobalParams::Instance()->GetScanSummary());
 }
@@ -0,0 +1,110 @@
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include "TntScan.hh"
+#include "TntGlobalParams.hh"
+#include "TntError.hh"
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+
+namespace {
+/// Unwrapped point of \a eventID (may be past the end of the grid)
+G4int ScanIndex(G4int eventID)
+{
+	G4int job, njobs;
+	TntGlobalParams::Instance()->GetScanSplit(job, njobs);
+	return job + njobs*(eventID/TntGlobalParams::Instance()->GetScanEvents());
+}
+}
+
+TntScan* TntScan::GetInstance()
+{
+	static TntScan* scan =
+		TntGlobalParams::Instance()->GetBeamType() == "scan" ? new TntScan() : 0;
+	return scan;
+}
+
+TntScan::TntScan():
+	fWrapped(false)
+{
+	G4MUTEXINIT(fMutex);
+}
+
+TntScan::~TntScan()
+{ }
+
+G4int TntScan::GetNumPoints() const
+{
+	G4int num = 1;
+	for(G4int axis = 0; axis< 3; ++axis) {
+		G4double min, step;
+		G4int n;
+		TntGlobalParams::Instance()->GetScanAxis(axis, min, step, n);
+		num *= n;
+	}
+	return num;
+}
+
+G4int TntScan::GetPoint(G4int eventID) const
+{
+	return ScanIndex(eventID) % GetNumPoints();
+}
+
+G4ThreeVector TntScan::GetPosition(G4int point) const
+{
+	G4double pos[3];
+	for(G4int axis = 2; axis >= 0; --axis) { // z runs fastest
+		G4double min, step;
+		G4int n;
+		TntGlobalParams::Instance()->GetScanAxis(axis, min, step, n);
+		pos[axis] = min + (point % n)*step;
+		point /= n;
+	}
+	return G4ThreeVector(pos[0], pos[1], pos[2]);
+}
+
+void TntScan::Fill(G4int eventID, G4double light, G4int photons, const G4ThreeVector& centroid)
+{
+	const G4int point = GetPoint(eventID);
+	G4AutoLock lock(&fMutex);
+	if(!fWrapped && ScanIndex(eventID) >= GetNumPoints()) {
+		TNTWAR << "TntScan::Fill:: More events than points to scan, starting again from the first point" << G4endl;
+		fWrapped = true;
+	}
+	if(fPoints.empty()) {
+		Point empty = { 0, 0, 0., 0., 0., G4ThreeVector() };
+		fPoints.resize(GetNumPoints(), empty);
+	}
+
+	Point& p = fPoints[point];
+	++p.events;
+	if(light > TntGlobalParams::Instance()->GetScanThreshold()) { ++p.detected; }
+	p.light += light;
+	p.light2 += light*light;
+	p.photons += photons;
+	p.centroid += photons*centroid;
+}
+
+void TntScan::Write(const G4String& fileName)
+{
+	G4AutoLock lock(&fMutex);
+	std::ofstream out(fileName.c_str());
+	if(!out.good()) {
+		TNTERR << "TntScan::Write:: Cannot create " << fileName << G4endl;
+		return;
+	}
+	out << "# point  x y z (cm)  events  light rms (MeVee)  detected err  photons  centroid x y z (cm)\n";
+	for(size_t i=0; i< fPoints.size(); ++i) {
+		const Point& p = fPoints[i];
+		if(p.events == 0) { continue; }
+		const G4double n = p.events;
+		const G4double light = p.light/n;
+		const G4double prob = p.detected/n;
+		const G4ThreeVector pos = GetPosition(i)/cm;
+		const G4ThreeVector centroid = p.photons > 0 ? p.centroid/p.photons/cm : G4ThreeVector();
+		out << i << "  " << pos.x() << " " << pos.y() << " " << pos.z() << "  " << p.events << "  "
+				<< light << " " << sqrt(std::max(p.light2/n - light*light, 0.)) << "  "
+				<< prob << " " << sqrt(prob*(1 - prob)/n) << "  " << p.photons/n << "  "
+				<< centroid.x() << " " << centroid.y() << " " << centroid.z() << "\n";
+	}
+}
@@ -41,11 +41,11 @@ G4ThreadLocal G4Allocator<TntScintHit>* TntScintHitAllocator=0;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-TntScintHit::TntScintHit() : fEdep(0.), fPos(0.), fPhysVol(0) {}
+TntScintHit::TntScintHit() : fEdep(0.), fPos(0.), fPhysVol(0), Weight(1.) {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-TntScintHit::TntScintHit(G4VPhysicalVolume* pVol) : fPhysVol(pVol) {}
+TntScintHit::TntScintHit(G4VPhysicalVolume* pVol) : fPhysVol(pVol), Weight(1.) {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
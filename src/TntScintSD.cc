@@ -44,6 +44,8 @@
 #include "G4VProcess.hh"
 //by Shuya 160407
 #include "G4SDManager.hh"
+#include "G4EventManager.hh"
+#include "TntUserEventInformation.hh"
 
 namespace {
 
@@ -125,6 +127,7 @@ G4bool TntScintSD::ProcessHits(G4Step* aStep,G4TouchableHistory* ){
   scintHit->SetTrackID( aStep->GetTrack()->GetTrackID() );
   scintHit->SetParentTrackID( aStep->GetTrack()->GetParentID() );
   scintHit->SetTOF( aStep->GetPreStepPoint()->GetGlobalTime() );
+  scintHit->SetWeight( aStep->GetTrack()->GetWeight() );
 
   scintHit->SetParticleName( aStep->GetTrack()->GetDefinition()->GetParticleName() );
   scintHit->SetParticleCharge( aStep->GetTrack()->GetDefinition()->GetPDGCharge() );
@@ -309,7 +312,8 @@ void TntScintSD::EndOfEvent(G4HCofThisEvent* hitsCE)
 					edep,
 					theTrackID,
 					theParentTrackID,				
-					HitType
+					HitType,
+					theCurrentHit->GetWeight()
 				};
 
 				if(isNewTrack) {
@@ -472,6 +476,9 @@ void TntScintSD::EndOfEvent(G4HCofThisEvent* hitsCE)
 	// Send data from hit collection to DataRecordTree and FillTree and text files!
  
 	TntDataOutEV->senddataEV(1,totE);
+	TntUserEventInformation* eventInformation =
+		(TntUserEventInformation*)G4EventManager::GetEventManager()->GetUserInformation();
+	if(eventInformation) eventInformation->SetLight(totE);
 	TntDataOutEV->senddataEV(2,EsumProton);
 	TntDataOutEV->senddataEV(3,EsumAlpha);
 	TntDataOutEV->senddataEV(4,EsumC12);
@@ -573,6 +580,31 @@ G4double TntScintSD::ConvertToLight(G4String theName, G4double theCharge, G4doub
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4double TntScintSD::GetEventLight()
+{
+	if(!fScintCollection) return 0.;
+
+	// Same particle -> light conversion as EndOfEvent(), without drawing random
+	// numbers for the resolution so the event's random sequence is unchanged
+	const G4String conv = Light_Conv == "light+resol" ? "light-conv" : Light_Conv;
+	G4double light = 0.;
+	for(size_t i=0; i< fScintCollection->entries(); ++i) {
+		TntScintHit* hit = (*fScintCollection)[i];
+		const G4String name = hit->GetParticleName();
+		if(name == "proton" || name == "deuteron" || name == "triton")
+			light += ConvertToLight(name, 1, hit->GetEdep(), conv);
+		else if(name == "He3" || name == "alpha")
+			light += ConvertToLight(name, 2, hit->GetEdep(), conv);
+		else if(name == "C12" || name == "C13")
+			light += ConvertToLight(name, 6, hit->GetEdep(), conv);
+		else if(name == "e-" || name == "e+" || name == "gamma")
+			light += ConvertToLight("e-", -1, hit->GetEdep(), conv);
+	}
+	return light;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void TntScintSD::clear() {} 
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
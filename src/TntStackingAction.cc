@@ -32,6 +32,9 @@
 #include "TntStackingAction.hh"
 #include "TntUserEventInformation.hh"
 #include "TntSteppingAction.hh"
+#include "TntScintSD.hh"
+#include "TntGlobalParams.hh"
+#include "TntQECurve.hh"
 
 #include "G4ios.hh"
 #include "G4ParticleDefinition.hh"
@@ -40,14 +43,44 @@
 #include "G4RunManager.hh"
 #include "G4Event.hh"
 #include "G4EventManager.hh"
+#include "G4SDManager.hh"
+#include "G4StackManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-TntStackingAction::TntStackingAction() {}
+TntStackingAction::TntStackingAction()
+  : fPhotonThreshold(TntGlobalParams::Instance()->GetPhotonThreshold()*MeV),
+    fPhotonFraction(TntGlobalParams::Instance()->GetPhotonFraction()),
+    fQECurve(TntGlobalParams::Instance()->GetQEMode()=="birth" ?
+             TntGlobalParams::Instance()->GetQECurve() : 0),
+    fPhotonStage(false), fNumEvents(0), fNumDiscarded(0), fNumPhotonsDiscarded(0),
+    fNumPhotonsCreated(0), fNumPhotonsKilled(0), fNumPhotonsQE(0)
+{
+  //The light map calibration launches photons only, there is no light to test
+  if(TntGlobalParams::Instance()->GetLightMapBuild()) fPhotonThreshold = -1;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-TntStackingAction::~TntStackingAction() {}
+TntStackingAction::~TntStackingAction() {
+  if(fPhotonThreshold >= 0 && fNumEvents > 0){
+    G4cout << "TntStackingAction:: " << fNumDiscarded << " of " << fNumEvents
+           << " events with optical photons below the photon threshold ("
+           << fPhotonThreshold/MeV << " MeVee), " << fNumPhotonsDiscarded
+           << " photons not tracked" << G4endl;
+  }
+  if(fQECurve && fNumPhotonsCreated > 0){
+    G4cout << "TntStackingAction:: QE at birth rejected " << fNumPhotonsQE
+           << " of " << fNumPhotonsCreated << " photons" << G4endl;
+  }
+  if(fPhotonFraction < 1 && fNumPhotonsCreated > 0){
+    G4cout << "TntStackingAction:: photon roulette (fraction " << fPhotonFraction
+           << ") killed " << fNumPhotonsKilled << " of "
+           << fNumPhotonsCreated - fNumPhotonsQE << " photons" << G4endl;
+  }
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -61,13 +94,40 @@ TntStackingAction::ClassifyNewTrack(const G4Track * aTrack){
   //Count what process generated the optical photons
   if(aTrack->GetDefinition()==G4OpticalPhoton::OpticalPhotonDefinition()){
     // particle is optical photon
+    //Released from the waiting stack in NewStage(), already counted
+    if(fPhotonStage) return fUrgent;
+
     if(aTrack->GetParentID()>0){
       // particle is secondary
+      G4bool created = true;
       if(aTrack->GetCreatorProcess()->GetProcessName()=="Scintillation")
         eventInformation->IncPhotonCount_Scint();
       else if(aTrack->GetCreatorProcess()->GetProcessName()=="Cerenkov")
         eventInformation->IncPhotonCount_Ceren();
+      else
+        created = false; //e.g. WLS, already thinned with its parent
+
+      if(created && (fQECurve || fPhotonFraction < 1)) ++fNumPhotonsCreated;
+
+      //PMT quantum efficiency, sampled now rather than at the photocathode
+      if(created && fQECurve){
+        if(G4UniformRand() >= fQECurve->GetQE(aTrack->GetKineticEnergy())){
+          ++fNumPhotonsQE;
+          return fKill;
+        }
+      }
+
+      //Russian roulette on newly created photons
+      if(created && fPhotonFraction < 1){
+        if(G4UniformRand() >= fPhotonFraction){
+          ++fNumPhotonsKilled;
+          return fKill;
+        }
+        const_cast<G4Track*>(aTrack)->SetWeight(aTrack->GetWeight()/fPhotonFraction);
+      }
     }
+    //Wait until the event's light is known
+    if(fPhotonThreshold >= 0) return fWaiting;
   }
   else{
   }
@@ -76,8 +136,25 @@ TntStackingAction::ClassifyNewTrack(const G4Track * aTrack){
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void TntStackingAction::NewStage() {}
+void TntStackingAction::NewStage() {
+  //Only optical photons are ever put in the waiting stack; by now they have
+  //been moved to the urgent stack, and all other particles are done
+  if(fPhotonThreshold < 0 || fPhotonStage) return;
+  fPhotonStage = true;
+  ++fNumEvents;
+
+  TntScintSD* scintSD = (TntScintSD*)G4SDManager::GetSDMpointer()
+    ->FindSensitiveDetector("/TntDet/scintSD", false);
+  G4double light = scintSD ? scintSD->GetEventLight() : 0.;
+  if(light < fPhotonThreshold){
+    ++fNumDiscarded;
+    fNumPhotonsDiscarded += stackManager->GetNUrgentTrack();
+    stackManager->clear();
+  }
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void TntStackingAction::PrepareNewEvent() {}
+void TntStackingAction::PrepareNewEvent() {
+  fPhotonStage = false;
+}
@@ -38,6 +38,7 @@
 #include "TntUserEventInformation.hh"
 #include "TntSteppingMessenger.hh"
 #include "TntRecorderBase.hh"
+#include "TntGlobalParams.hh"
 
 #include "G4SteppingManager.hh"
 #include "G4SDManager.hh"
@@ -51,6 +52,7 @@
 #include "G4VPhysicalVolume.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4ParticleTypes.hh"
+#include "G4SystemOfUnits.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -60,6 +62,13 @@ TntSteppingAction::TntSteppingAction(TntRecorderBase* r)
   fSteppingMessenger = new TntSteppingMessenger(this);
 
   fExpectedNextStatus = Undefined;
+
+  TntGlobalParams* params = TntGlobalParams::Instance();
+  fPhotonTimeCut = params->GetPhotonTimeCut();
+  if(fPhotonTimeCut>=0) fPhotonTimeCut*=ns;
+  fPhotonMaxReflections = params->GetPhotonMaxReflections();
+  fPhotonMaxPath = params->GetPhotonMaxPath();
+  if(fPhotonMaxPath>=0) fPhotonMaxPath*=mm;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -89,8 +98,10 @@ void TntSteppingAction::UserSteppingAction(const G4Step * theStep){
   G4OpBoundaryProcessStatus boundaryStatus=Undefined;
   static G4ThreadLocal G4OpBoundaryProcess* boundary=NULL;
 
-  //find the boundary process only once
-  if(!boundary){
+  //find the boundary process only once (only optical photons have one, so
+  //don't search the process list of every other particle at each step)
+  if(!boundary &&
+     theTrack->GetDefinition()==G4OpticalPhoton::OpticalPhotonDefinition()){
     G4ProcessManager* pm
       = theStep->GetTrack()->GetDefinition()->GetProcessManager();
     G4int nprocesses = pm->GetProcessListLength();
@@ -186,13 +197,19 @@ void TntSteppingAction::UserSteppingAction(const G4Step * theStep){
   G4ParticleDefinition* particleType = theTrack->GetDefinition();
   if(particleType==G4OpticalPhoton::OpticalPhotonDefinition()){
     //Optical photon only
+    if(theTrack->GetCurrentStepNumber()==1) eventInformation->IncPhotonTracked();
 
     if(thePrePV->GetName()=="Slab")
       //force drawing of photons in WLS slab
       trackInformation->SetForceDrawTrajectory(true);
-    else if(thePostPV->GetName()=="expHall")
-      //Kill photons entering expHall from something other than Slab
+    else if(thePostPV->GetName()=="expHall"){
+      //Kill photons entering expHall from something other than Slab,
+      //counting those leaving a WLS fiber through its end
+      const G4String& preName=thePrePV->GetName();
+      if(preName=="Fiber"||preName=="Cladding1"||preName=="Cladding2")
+        eventInformation->AddFiberEndPhoton(theTrack->GetGlobalTime());
       theTrack->SetTrackStatus(fStopAndKill);
+    }
 
     //Was the photon absorbed by the absorption process
     if(thePostPoint->GetProcessDefinedStep()->GetProcessName()
@@ -255,6 +272,23 @@ void TntSteppingAction::UserSteppingAction(const G4Step * theStep){
       if(thePostPV->GetName()=="sphere")
         trackInformation->AddTrackStatusFlag(hitSphere);
     }
+
+    //Kill photons that can no longer make a useful hit
+    if(theTrack->GetTrackStatus()==fAlive){
+      if(fPhotonTimeCut>=0 && theTrack->GetGlobalTime()>fPhotonTimeCut){
+        theTrack->SetTrackStatus(fStopAndKill);
+        eventInformation->IncPhotonCut(TntUserEventInformation::kCutTime);
+      }
+      else if(fPhotonMaxReflections>=0 &&
+              trackInformation->GetReflectionCount()>fPhotonMaxReflections){
+        theTrack->SetTrackStatus(fStopAndKill);
+        eventInformation->IncPhotonCut(TntUserEventInformation::kCutReflections);
+      }
+      else if(fPhotonMaxPath>=0 && theTrack->GetTrackLength()>fPhotonMaxPath){
+        theTrack->SetTrackStatus(fStopAndKill);
+        eventInformation->IncPhotonCut(TntUserEventInformation::kCutPath);
+      }
+    }
   }
 
   if(fRecorder)fRecorder->RecordStep(theStep);
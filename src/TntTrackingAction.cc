@@ -34,8 +34,10 @@
 #include "TntUserTrackInformation.hh"
 #include "TntDetectorConstruction.hh"
 #include "TntRecorderBase.hh"
+#include "TntUserEventInformation.hh"
 
 #include "G4TrackingManager.hh"
+#include "G4EventManager.hh"
 #include "G4Track.hh"
 #include "G4ParticleTypes.hh"
 
@@ -57,6 +59,19 @@ void TntTrackingAction::PreUserTrackingAction(const G4Track* aTrack)
   //This user track information is only relevant to the photons
   fpTrackingManager->SetUserTrackInformation(new TntUserTrackInformation);
 
+  //Primary each track descends from, for the hit attribution in
+  //TntDataRecordTree. Primaries have one particle per vertex, so primary i
+  //is track i+1. Optical photons are skipped, they never make hits.
+  if(aTrack->GetDefinition()!=G4OpticalPhoton::OpticalPhotonDefinition()){
+    TntUserEventInformation* eventInformation=(TntUserEventInformation*)
+      G4EventManager::GetEventManager()->GetUserInformation();
+    if(eventInformation){
+      G4int parentID=aTrack->GetParentID();
+      eventInformation->SetPrimaryOfTrack(aTrack->GetTrackID(),
+        parentID==0 ? aTrack->GetTrackID()-1 : eventInformation->GetPrimaryOfTrack(parentID));
+    }
+  }
+
   /*  const G4VProcess* creator = aTrack->GetCreatorProcess();
   if(creator)
     G4cout<<creator->GetProcessName()<<G4endl;
@@ -35,8 +35,12 @@
 
 TntUserEventInformation::TntUserEventInformation()
   :fHitCount(0),fPhotonCount_Scint(0),fPhotonCount_Ceren(0),fAbsorptionCount(0),
-   fBoundaryAbsorptionCount(0),fTotE(0.),fEWeightPos(0.),fReconPos(0.),fConvPos(0.),
-   fConvPosSet(false),fPosMax(0.),fEdepMax(0.),fPMTsAboveThreshold(0) {}
+   fBoundaryAbsorptionCount(0),fTotE(0.),fLight(0.),fEWeightPos(0.),fReconPos(0.),fConvPos(0.),
+   fConvPosSet(false),fPosMax(0.),fEdepMax(0.),fPMTsAboveThreshold(0),
+   fPhotonTracked(0),fFiberCaptured(0),fFiberEndCount(0),fFiberEndTime(0.)
+{
+  for(G4int i=0;i<kNumPhotonCuts;i++)fPhotonCutCount[i]=0;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -58,7 +58,7 @@ TntWLSFiber::TntWLSFiber(G4RotationMatrix *pRot,
   G4Tubs* fiber_tube =
    new G4Tubs("Fiber",fFiber_rmin,fFiber_rmax,fFiber_z,fFiber_sphi,fFiber_ephi);
  
-  G4LogicalVolume* fiber_log =
+  fFiber_log =
       new G4LogicalVolume(fiber_tube,G4Material::GetMaterial("PMMA"),
                           "Fiber",0,0,0);
  
@@ -82,7 +82,7 @@ TntWLSFiber::TntWLSFiber(G4RotationMatrix *pRot,
       new G4LogicalVolume(clad2_tube,G4Material::GetMaterial("Pethylene2"),
                           "Cladding2",0,0,0);
  
-  new G4PVPlacement(0,G4ThreeVector(0.,0.,0.),fiber_log,
+  new G4PVPlacement(0,G4ThreeVector(0.,0.,0.),fFiber_log,
                     "Fiber", clad1_log,false,0);
   new G4PVPlacement(0,G4ThreeVector(0.,0.,0.),clad1_log,
                     "Cladding1",fClad2_log,false,0);
@@ -0,0 +1,98 @@
+#include <cmath>
+#include <algorithm>
+#include "TntWLSFiberModel.hh"
+#include "TntUserEventInformation.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4EventManager.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4VProcess.hh"
+#include "G4VSolid.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+TntWLSFiberModel::TntWLSFiberModel(const G4String& name, G4Region* envelope,
+																	 G4MaterialPropertiesTable* core,
+																	 const std::vector<G4MaterialPropertiesTable*>& cladding):
+	G4VFastSimulationModel(name, envelope),
+	fCoreRindex(core->GetProperty("RINDEX")),
+	fGroupVel(core->GetProperty("GROUPVEL")),
+	fWLSAbsLength(core->GetProperty("WLSABSLENGTH")),
+	fAbsLength(core->GetProperty("ABSLENGTH"))
+{
+	for(size_t i=0; i< cladding.size(); ++i) {
+		fCladRindex.push_back(cladding[i]->GetProperty("RINDEX"));
+	}
+}
+
+TntWLSFiberModel::~TntWLSFiberModel()
+{ }
+
+G4bool TntWLSFiberModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+	return &particle == G4OpticalPhoton::OpticalPhotonDefinition();
+}
+
+G4bool TntWLSFiberModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+	// Only photons re-emitted in the core, at their first step
+	const G4Track* track = fastTrack.GetPrimaryTrack();
+	if(track->GetCurrentStepNumber() != 1) { return false; }
+	const G4VProcess* creator = track->GetCreatorProcess();
+	if(!creator || creator->GetProcessName() != "OpWLS") { return false; }
+	return IsTrapped(fastTrack.GetEnvelopeSolid(), fastTrack.GetPrimaryTrackLocalPosition(),
+									 fastTrack.GetPrimaryTrackLocalDirection(), track->GetKineticEnergy());
+}
+
+G4bool TntWLSFiberModel::IsTrapped(const G4VSolid* core, const G4ThreeVector& pos,
+																	 const G4ThreeVector& dir, G4double energy) const
+{
+	G4double dist = core->DistanceToOut(pos, dir);
+	G4ThreeVector normal = core->SurfaceNormal(pos + dist*dir);
+	if(std::fabs(normal.z()) > 0.5) { return false; } // end of the fiber first
+
+	// Total internal reflection at the wall (or at a cladding interface)
+	G4double nCore = fCoreRindex->Value(energy);
+	G4double nClad = nCore;
+	for(size_t i=0; i< fCladRindex.size(); ++i) {
+		nClad = std::min(nClad, fCladRindex[i]->Value(energy));
+	}
+	G4double cosInc = dir.dot(normal);
+	return 1. - cosInc*cosInc > (nClad/nCore)*(nClad/nCore);
+}
+
+void TntWLSFiberModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+	const G4Track* track = fastTrack.GetPrimaryTrack();
+	const G4ThreeVector& pos = fastTrack.GetPrimaryTrackLocalPosition();
+	const G4ThreeVector& dir = fastTrack.GetPrimaryTrackLocalDirection();
+	G4double energy = track->GetKineticEnergy();
+	fastStep.KillPrimaryTrack();
+
+	TntUserEventInformation* eventInformation = (TntUserEventInformation*)
+		G4EventManager::GetEventManager()->GetUserInformation();
+	if(eventInformation) { eventInformation->IncFiberCaptured(); }
+	if(dir.z() == 0) { fastStep.ProposePrimaryTrackPathLength(0.); return; }
+
+	// Path to the end the photon is heading for (the fiber axis is z)
+	G4ThreeVector axis(0., 0., dir.z() > 0 ? 1. : -1.);
+	G4double path = fastTrack.GetEnvelopeSolid()->DistanceToOut(pos, axis)/std::fabs(dir.z());
+
+	// Absorption on the way
+	G4double mu = 0;
+	if(fWLSAbsLength && fWLSAbsLength->Value(energy) > 0) { mu += 1./fWLSAbsLength->Value(energy); }
+	if(fAbsLength && fAbsLength->Value(energy) > 0) { mu += 1./fAbsLength->Value(energy); }
+	G4bool absorbed = false;
+	if(mu > 0) {
+		G4double s = -std::log(1. - G4UniformRand())/mu;
+		if(s < path) { path = s; absorbed = true; }
+	}
+
+	G4double speed = fGroupVel ? fGroupVel->Value(energy) : c_light/fCoreRindex->Value(energy);
+	G4double time = track->GetGlobalTime() + path/speed;
+	fastStep.ProposePrimaryTrackPathLength(path);
+	fastStep.ProposePrimaryTrackFinalTime(time);
+	if(!absorbed && eventInformation) { eventInformation->AddFiberEndPhoton(time); }
+}
@@ -73,8 +73,8 @@ TntWLSSlab::TntWLSSlab(G4RotationMatrix *pRot,
   //Place fibers
   for(G4int i=0;i<fNfibers;i++){
      G4double Y=-(spacing)*(fNfibers-1)*0.5 + i*spacing;
-     new TntWLSFiber(rm,G4ThreeVector(0.,Y,0.),fScintSlab_log,false,0,
-                     fConstructor);
+     fFibers.push_back(new TntWLSFiber(rm,G4ThreeVector(0.,Y,0.),
+                                       fScintSlab_log,false,0,fConstructor));
   }
  
   SetLogicalVolume(fScintSlab_log);
@@ -61,8 +61,88 @@
 #include "TntDataRecordTree.hh"
 #include <cmath>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
 
 #include "TntMainVolume.hh"
+#include "G4Threading.hh"
+#include "G4Navigator.hh"
+#include "G4TransportationManager.hh"
+
+namespace {
+// Inverts a monotonic CDF on [Low,High] by bisection (table building only)
+template<class CDF_t>
+G4double InvertCDF(const CDF_t& theCDF, G4double u, G4double Low, G4double High)
+{
+  for(G4int i=0; i<60; i++)
+    {
+      G4double Mid = 0.5*(Low+High);
+      if(theCDF(Mid) < u)
+	{ Low = Mid; }
+      else
+	{ High = Mid; }
+    }
+  return 0.5*(Low+High);
+}
+
+// n+p above 29 MeV: isotropic with weight RAT, plus 3/2 cos^2 - see NP_AngDist()
+struct NP_AngDist_CDF
+{
+  G4double RAT;
+  G4double operator()(G4double CosCM) const
+  { return 0.5*(RAT*(CosCM+1.) + (1.-RAT)*(pow(CosCM,3)+1.)); }
+};
+
+struct NP_AngDist_Quantile
+{
+  G4double operator()(G4double NEng, G4double u) const
+  {
+    NP_AngDist_CDF theCDF;
+    theCDF.RAT = 1./(1.+((NEng/29.-1.)/3.));
+    return InvertCDF(theCDF, u, -1., 1.);
+  }
+};
+
+// Evaporation: y = E/T on [0,XEV] with dp/dy ~ y*exp(-y) - see Evaporate_Eng()
+struct Evaporate_CDF
+{
+  G4double XEV;
+  G4double operator()(G4double Fraction) const
+  {
+    G4double y = Fraction*XEV;
+    return (1.-(1.+y)*exp(-y))/(1.-(1.+XEV)*exp(-XEV));
+  }
+};
+
+struct Evaporate_Quantile
+{
+  // Tabulated vs. sqrt(u), in which E/Available_Eng is nearly linear at small u
+  G4double operator()(G4double XEV, G4double SqrtU) const
+  {
+    Evaporate_CDF theCDF;
+    theCDF.XEV = XEV;
+    return InvertCDF(theCDF, SqrtU*SqrtU, 0., 1.);
+  }
+};
+
+// Two-sample Kolmogorov-Smirnov statistic
+G4double KS_Statistic(std::vector<G4double>& Sample1, std::vector<G4double>& Sample2)
+{
+  std::sort(Sample1.begin(), Sample1.end());
+  std::sort(Sample2.begin(), Sample2.end());
+  const G4double N1 = Sample1.size(), N2 = Sample2.size();
+  size_t i = 0, j = 0;
+  G4double D = 0.;
+  while(i < Sample1.size() && j < Sample2.size())
+    {
+      G4double x = std::min(Sample1[i], Sample2[j]);
+      while(i < Sample1.size() && Sample1[i] <= x) { i++; }
+      while(j < Sample2.size() && Sample2[j] <= x) { j++; }
+      D = std::max(D, std::fabs(i/N1 - j/N2));
+    }
+  return D;
+}
+}
 
 menate_R::menate_R(const G4String& processName) : G4VDiscreteProcess(processName)
 {
@@ -78,6 +158,28 @@ menate_R::menate_R(const G4String& processName) : G4VDiscreteProcess(processName
 
   CalcMeth="ORIGINAL";
 
+  Use_Sampler_Tables = (TntGlobalParams::Instance()->GetMenateR_Sampler() == "table");
+
+  theC12Definition = 0;
+  theBe9Definition = 0;
+  theB12Definition = 0;
+  theB11Definition = 0;
+  theC11Definition = 0;
+
+  Force_Interaction = TntGlobalParams::Instance()->GetMenateR_Force();
+  Force_Sampled = false;
+  Force_Pending = false;
+  Force_Weight = 1.;
+  Force_Length = 0.;
+  theForceNavigator = 0;
+
+  Benchmark = TntGlobalParams::Instance()->GetMenateR_Benchmark();
+  for(G4int i=0; i<8; i++)
+    {
+      Bench_Time[i] = 0.;
+      Bench_Count[i] = 0;
+    }
+
   G4cout << "Constructor for menate_R process was called! " << G4endl;
   G4cout << "A non-relativistic model for n - scattering ";
   G4cout << "on carbon and hydrogen or materials composed of it (e.g. NE213)" << G4endl;
@@ -116,29 +218,275 @@ menate_R::menate_R(const G4String& processName) : G4VDiscreteProcess(processName
 	}
     }
 
+  Has_H = H_Switch;
+  Has_C = C_Switch;
+
   // Load Cross Sections if Element is Found
+  LoadCrossSections();
+
+  if(TntGlobalParams::Instance()->GetMenateR_Validate() > 0 && G4Threading::IsMasterThread())
+    { ValidateSamplerTables(TntGlobalParams::Instance()->GetMenateR_Validate()); }
+}
+
+
+menate_R::~menate_R()
+{
+  if(Benchmark == true)
+    { PrintBenchmark(); }
+  delete theForceNavigator;
+}
+
+
+void menate_R::BuildPhysicsTable(const G4ParticleDefinition&)
+{
+  ResolveParticleDefinitions();
+}
+
+
+void menate_R::ResolveParticleDefinitions()
+{
+  // GetIon() Method works whether particle exists in physicslist or not. 
+  // Arguements are GetIon(Charge,Mass,ExcitationEng)
+  G4IonTable* theIonTable = G4IonTable::GetIonTable();
+  theC12Definition = theIonTable->GetIon(6,12,0.);
+  theBe9Definition = theIonTable->GetIon(4,9,0.);
+  theB12Definition = theIonTable->GetIon(5,12,0.);
+  theB11Definition = theIonTable->GetIon(5,11,0.);
+  theC11Definition = theIonTable->GetIon(6,11,0.);
+}
+
+
+const menate_R::MaterialParams& menate_R::GetMaterialParams(const G4Material* theMaterial)
+{
+  // Cached by material index; only filled the first time a material is seen
+  size_t Index = theMaterial->GetIndex();
+  if(Index >= theMaterialParams.size())
+    { theMaterialParams.resize(G4Material::GetNumberOfMaterials()); }
+
+  MaterialParams& theParams = theMaterialParams[Index];
+  if(theParams.Valid == true)
+    { return theParams; }
+
+  // GetVecNbOfAtomsPerVolume() returns (NumberOfAtoms/mm3)! 
+  const G4double* N_Per_Volume = theMaterial->GetVecNbOfAtomsPerVolume();
+  const G4ElementVector* theElementList = theMaterial->GetElementVector();
+  G4int NumberOfElements = theMaterial->GetNumberOfElements();
+
+  theParams.H_Switch = false;
+  theParams.C_Switch = false;
+  theParams.Num_H = 0.;
+  theParams.Num_C = 0.;
+
+  for(G4int ne=0;ne<NumberOfElements;ne++)
+    {
+      const G4Element* theElement = (*theElementList)[ne];
+      G4int theZ = static_cast<int>(theElement->GetZ());
+      G4int theA = static_cast<int>(theElement->GetN());
+
+      if(theZ == 1 && theA == 1)
+	{
+	  theParams.H_Switch = true;
+	  theParams.Num_H = N_Per_Volume[ne];
+	}
+      else if(theZ == 6 && theA == 12)
+	{
+	  theParams.C_Switch = true;
+	  theParams.Num_C = N_Per_Volume[ne];
+	}
+    }
+
+  // MENATE works with the mass of the "molecule" containing one carbon atom,
+  // i.e. CH_x -> 12 + x for the hydrocarbon scintillators. For materials
+  // without carbon, fall back to the mean atomic mass.
+  G4double Atoms = theParams.C_Switch ? theParams.Num_C : theMaterial->GetTotNbOfAtomsPerVolume();
+  theParams.AMass = (Atoms > 0.) ? theMaterial->GetDensity()*Avogadro/Atoms/(g/mole) : 12.;
+  theParams.Density = theMaterial->GetDensity()/(g/cm3);
+  theParams.Valid = true;
+
+  G4cout << "menate_R:: Material " << theMaterial->GetName() << " : AMass = " << theParams.AMass 
+	 << ", density = " << theParams.Density << " g/cm3" << G4endl;
+
+  return theParams;
+}
+
+
+void menate_R::PrintBenchmark()
+{
+  G4cout << "menate_R:: PostStepDoIt benchmark (thread " << G4Threading::G4GetThreadId() << ")" << G4endl;
+  G4cout << "   " << std::setw(16) << "Reaction" << std::setw(12) << "Count" 
+	 << std::setw(12) << "Time (s)" << std::setw(16) << "Interactions/s" << G4endl;
+  for(G4int i=0; i<8; i++)
+    {
+      // Printed from the destructor, after main() deleted TntPointer
+      G4String Name = TntDataRecordTree::GetReactionName(i+1);
+      G4cout << "   " << std::setw(16) << Name << std::setw(12) << Bench_Count[i] 
+	     << std::setw(12) << Bench_Time[i] << std::setw(16) 
+	     << (Bench_Time[i] > 0. ? Bench_Count[i]/Bench_Time[i] : 0.) << G4endl;
+    }
+}
+
 
-	  if(H_Switch == true)
-	    { ReadCrossSectionFile("Hydrogen1_el.dat",theHydrogenXS);}
+void menate_R::LoadCrossSections()
+{
+  TntGlobalParams* params = TntGlobalParams::Instance();
+  XS_Version = params->GetXSVersion();
+
+  // Channel names are the reaction names from ChooseReaction(), so the
+  // 'xsfile' input key uses the same names as the ReactionCodes in the output
+  const G4String Channels[] = { "N_P_elastic", "N_C12_elastic", "N_C12_NGamma", "N_C12_A_Be9",
+                                "N_C12_P_B12", "N_C12_NNP_B11", "N_C12_N2N_C11", "N_C12_NN3Alpha" };
+  const G4int NumChannels = sizeof(Channels)/sizeof(Channels[0]);
+
+  const std::map<G4String, G4String>& theSelection = params->GetXSFiles();
+  for(std::map<G4String, G4String>::const_iterator it = theSelection.begin(); it != theSelection.end(); ++it)
+    {
+      if(std::find(Channels, Channels+NumChannels, it->first) == Channels+NumChannels)
+	{ G4cerr << "menate_R::LoadCrossSections() - Unknown channel \"" << it->first 
+		 << "\" in xsfile selection, ignoring it!" << G4endl; }
+    }
+
+	  if(Has_H == true)
+	    { ReadCrossSectionFile(params->GetXSFile("N_P_elastic","Hydrogen1_el.dat"),theHydrogenXS);}
 	  
-	  if(C_Switch == true)
+	  if(Has_C == true)
 	    { 
 	      // Load all Carbon Elastic and Inelastic Cross Sections
-	      ReadCrossSectionFile("Carbon12_el.dat",theCarbonXS); 
-	      ReadCrossSectionFile("Carbon12_nng4_4.dat",theC12NGammaXS);
-	      ReadCrossSectionFile("Carbon12_na9Be.dat",theC12ABe9XS);
-	      ReadCrossSectionFile("Carbon12_np12B.dat",theC12NPB12XS);
-	      ReadCrossSectionFile("Carbon12_nnp11B.dat",theC12NNPB11XS);
-	      ReadCrossSectionFile("Carbon12_2n11C.dat",theC12N2NC11XS);
-	      ReadCrossSectionFile("Carbon12_nn3a.dat",theC12NN3AlphaXS);
+	      ReadCrossSectionFile(params->GetXSFile("N_C12_elastic","Carbon12_el.dat"),theCarbonXS); 
+	      ReadCrossSectionFile(params->GetXSFile("N_C12_NGamma","Carbon12_nng4_4.dat"),theC12NGammaXS);
+	      ReadCrossSectionFile(params->GetXSFile("N_C12_A_Be9","Carbon12_na9Be.dat"),theC12ABe9XS);
+	      ReadCrossSectionFile(params->GetXSFile("N_C12_P_B12","Carbon12_np12B.dat"),theC12NPB12XS);
+	      ReadCrossSectionFile(params->GetXSFile("N_C12_NNP_B11","Carbon12_nnp11B.dat"),theC12NNPB11XS);
+	      ReadCrossSectionFile(params->GetXSFile("N_C12_N2N_C11","Carbon12_2n11C.dat"),theC12N2NC11XS);
+	      ReadCrossSectionFile(params->GetXSFile("N_C12_NN3Alpha","Carbon12_nn3a.dat"),theC12NN3AlphaXS);
 	    }
 	    
   G4cout << "Finished Building Cross Section Table! " << G4endl;
+
+  BuildSamplerTables();
 }
 
 
-menate_R::~menate_R()
-{;}
+void menate_R::BuildSamplerTables()
+{
+  theNPAngDistTable.Clear();
+  theEvaporateTable.Clear();
+  theNC12SlopeEng.clear();
+  theNC12Slope.clear();
+
+  if(Use_Sampler_Tables == false && TntGlobalParams::Instance()->GetMenateR_Validate() <= 0)
+    { return; }
+
+  const G4int NumU = 257;
+  std::vector<G4double> theGrid;
+
+  if(Has_H == true && !theHydrogenXS.empty())
+    {
+      // Only anisotropic above 29 MeV (see NP_AngDist), up to the end of the XS table
+      const G4double EMax = theHydrogenXS.back().GetKinEng();
+      const G4int NumE = 200;
+      if(EMax > 29.*MeV)
+	{
+	  for(G4int i=0; i<=NumE; i++)
+	    { theGrid.push_back(29.*MeV + (EMax-29.*MeV)*i/NumE); }
+	  theNPAngDistTable.Build(theGrid, NumU, NP_AngDist_Quantile());
+	}
+    }
+
+  if(Has_C == true && !theCarbonXS.empty())
+    {
+      // The n+12C diffractive peak is a truncated exponential in 1-cos, whose
+      // inverse CDF is closed-form; only its slope needs a table. The slope is
+      // sampled at the carbon elastic XS energies above the isotropic region
+      // and interpolated linearly between those energies.
+      theNC12SlopeEng.push_back(7.35*MeV);
+      for(size_t k=0; k<theCarbonXS.size(); k++)
+	{
+	  if(theCarbonXS[k].GetKinEng() > 7.35*MeV)
+	    { theNC12SlopeEng.push_back(theCarbonXS[k].GetKinEng()); }
+	}
+      for(size_t k=0; k<theNC12SlopeEng.size(); k++)
+	{ theNC12Slope.push_back(NC12_Slope(theNC12SlopeEng[k])); }
+      if(theNC12SlopeEng.size() < 2)
+	{ theNC12SlopeEng.clear(); theNC12Slope.clear(); }
+
+      // Evaporation is only used in the 12C breakup channels.
+      // Available_Eng/T up to 40 covers several hundred MeV excitation.
+      const G4int NumX = 400;
+      const G4double XMin = 1e-4, XMax = 40.;
+      theGrid.clear();
+      for(G4int i=0; i<=NumX; i++)
+	{ theGrid.push_back(XMin + (XMax-XMin)*i/NumX); }
+      theEvaporateTable.Build(theGrid, NumU, Evaporate_Quantile());
+    }
+
+  G4cout << "Finished Building Inverse-CDF Sampler Tables! " << G4endl;
+}
+
+
+void menate_R::ValidateSamplerTables(G4int NumSamples)
+{
+  // Critical value of the two-sample KS statistic at 1% significance
+  const G4double DCrit = 1.628*sqrt(2./NumSamples);
+
+  G4cout << "menate_R:: Validating inverse-CDF sampler tables against analytic samplers, " 
+	 << NumSamples << " samples each, KS critical value (1%) = " << DCrit << G4endl;
+
+  const G4String SamplerName[3] = { "NP_AngDist", "NC12_DIFF", "Evaporate_Eng" };
+  const G4double SamplerEng[3][4] = { { 30.*MeV, 50.*MeV, 100.*MeV, 300.*MeV },    // NEng
+				      { 10.*MeV, 20.*MeV, 50.*MeV, 100.*MeV },     // NEng
+				      { 0.5*MeV, 2.*MeV, 5.*MeV, 20.*MeV } };      // Available_Eng
+
+  const G4bool Use_Tables = Use_Sampler_Tables;
+  G4int NumFailed = 0;
+  std::vector<G4double> theSamples[2];
+
+  for(G4int s=0; s<3; s++)
+    {
+      if((s == 0 && Has_H == false) || (s > 0 && Has_C == false))
+	{ continue; }
+
+      for(G4int e=0; e<4; e++)
+	{
+	  for(G4int t=0; t<2; t++)
+	    {
+	      Use_Sampler_Tables = (t == 1);
+	      theSamples[t].resize(NumSamples);
+	      for(G4int i=0; i<NumSamples; i++)
+		{
+		  if(s == 0)
+		    { theSamples[t][i] = NP_AngDist(SamplerEng[s][e]); }
+		  else if(s == 1)
+		    { theSamples[t][i] = NC12_DIFF(SamplerEng[s][e]); }
+		  else
+		    { theSamples[t][i] = Evaporate_Eng(12.,SamplerEng[s][e]); }
+		}
+	    }
+
+	  G4double D = KS_Statistic(theSamples[0], theSamples[1]);
+	  if(D > DCrit)
+	    { NumFailed++; }
+	  G4cout << "   " << std::setw(14) << SamplerName[s] << " at " << std::setw(6) << SamplerEng[s][e]/MeV 
+		 << " MeV : D = " << std::setw(10) << D << (D > DCrit ? "  FAILED" : "  passed") << G4endl;
+	}
+    }
+
+  Use_Sampler_Tables = Use_Tables;
+  G4cout << "menate_R:: Sampler table validation finished, " << NumFailed << " failed" << G4endl;
+}
+
+
+void menate_R::StartTracking(G4Track* aTrack)
+{
+  G4VDiscreteProcess::StartTracking(aTrack);
+
+  // Cross section selection changed between runs (e.g. in the
+  // cross-section comparison mode of main()) - read the new files
+  if(XS_Version != TntGlobalParams::Instance()->GetXSVersion())
+    { LoadCrossSections(); }
+
+  Force_Sampled = false;
+  Force_Pending = false;
+}
 
 
 G4double menate_R::Absolute(G4double Num)
@@ -161,7 +509,7 @@ G4double menate_R::SIGN(G4double A1, G4double B2)
   return A1;
 }
 
-void menate_R::ReadCrossSectionFile(G4String FileName, CrossSectionClass* theReactionXS)
+void menate_R::ReadCrossSectionFile(G4String FileName, std::vector<CrossSectionClass>& theReactionXS)
 {
   //
   // Example to get the Cross Section data from environment variable set in bashrc file.
@@ -183,9 +531,11 @@ void menate_R::ReadCrossSectionFile(G4String FileName, CrossSectionClass* theRea
  // 2/24/16 - BTR - directory where you find the cross sections.
 
 	// Get MENATEG4 directory from preprocessor definition, set in CMakeLists.txt
+	// Absolute paths (e.g. from the 'xsfile' input key) are used as given.
 	G4String DirName = G4String(TNTSIM_SOURCE_DIR) + "/MENATEG4";
 	
-	FileName = DirName+"/"+FileName;
+	if(FileName.empty() || FileName[0] != '/')
+	  { FileName = DirName+"/"+FileName; }
 
   G4String ElementName;
   G4int NumberOfLines = 0;
@@ -199,6 +549,7 @@ void menate_R::ReadCrossSectionFile(G4String FileName, CrossSectionClass* theRea
       theFile >> ElementName;
 
       G4cout << "Loading Data For : " << ElementName << " , FileName = " << FileName << G4endl;
+      theReactionXS.assign(NumberOfLines, CrossSectionClass());
       for(G4int k=0; k<NumberOfLines; k++)
 	{
 	  G4double theEnergy;
@@ -225,11 +576,14 @@ void menate_R::ReadCrossSectionFile(G4String FileName, CrossSectionClass* theRea
 } 
 
 
-G4double menate_R::GetCrossSection(G4double KinEng, CrossSectionClass* theReactionXS)
+G4double menate_R::GetCrossSection(G4double KinEng, std::vector<CrossSectionClass>& theReactionXS)
 {
   G4double CrossSection=0.;
   G4int NumberOfLines;
 
+      if(theReactionXS.empty())
+	{ return 0.; } // Table not loaded (element not in any material)
+
       NumberOfLines = theReactionXS[0].GetNumberOfLines();	
       
       if(KinEng > (theReactionXS[NumberOfLines-1].GetKinEng()))
@@ -373,6 +727,8 @@ G4double menate_R::Evaporate_Eng(G4double AMass,G4double Available_Eng)
 
   if(XEV < 1e-4)
     { Evap_Eng = 0.; }
+  else if(Use_Sampler_Tables == true && theEvaporateTable.InRange(XEV))
+    { Evap_Eng = theEvaporateTable.Sample(XEV,sqrt(ALEA))*Available_Eng; }
   else
     {
       G4double ZNORM = 1. - (1.-(1.+XEV)*exp(-XEV))*ALEA;
@@ -499,6 +855,9 @@ G4double menate_R::NP_AngDist(G4double NEng)
       return CosCM;
     }
 
+  if(Use_Sampler_Tables == true && theNPAngDistTable.InRange(NEng))
+    { return theNPAngDistTable.Sample(NEng,G4UniformRand()); }
+
  //      a = 3.0/(3.0+rMax)
  //      b = rMax*a/3.0
  //      RAT = a/(a+b)
@@ -547,10 +906,6 @@ G4double menate_R::NC12_DIFF(G4double NEng)
   // Modifications added by Brian Roeder, LPC Caen, 19 May 2008.
 
   G4double CosCM = 0.;
-  G4double DiffSigma;
-  G4double FitParam = 0.5;
-  if(NEng >= 70.*MeV)
-    {FitParam = 0.021613*NEng-0.90484;} // Fit to AngDist Data
 
   if(NEng < 7.35*MeV)
     {
@@ -562,15 +917,28 @@ G4double menate_R::NC12_DIFF(G4double NEng)
       G4double rand = G4UniformRand();
       if(rand > 0.9)
 	{CosCM = 1.-2.*G4UniformRand();}
+      else if(Use_Sampler_Tables == true && !theNC12SlopeEng.empty() &&
+	      NEng <= theNC12SlopeEng.back())
+	{
+	  // Tabulated slope, then the exact inverse CDF of the loop below
+	  size_t k = std::upper_bound(theNC12SlopeEng.begin(), theNC12SlopeEng.end(), NEng) - theNC12SlopeEng.begin();
+	  if(k >= theNC12SlopeEng.size()) { k = theNC12SlopeEng.size()-1; }
+	  G4double Slope = GetXSInterpolation(NEng,theNC12SlopeEng[k-1],theNC12SlopeEng[k],
+					      theNC12Slope[k-1],theNC12Slope[k]);
+	  if(Slope < 1e-9)
+	    {CosCM = 1.-2.*G4UniformRand();}
+	  else
+	    {CosCM = std::max(-1., 1.+log1p(G4UniformRand()*expm1(-2.*Slope))/Slope);}
+	}
       else
 	{
-	  DiffSigma = GetCrossSection(NEng,theCarbonXS)/barn;	  
+	  G4double Slope = NC12_Slope(NEng);
 	  do
 	    {
 	      G4double rand2 = 0.;
 	      rand2 = G4UniformRand();
 	      //CosCM = 1.0+log(rand2)/1.17/DiffSigma/NEng;
-	      CosCM = 1.0+log(rand2)/FitParam/DiffSigma/NEng;
+	      CosCM = 1.0+log(rand2)/Slope;
 	    }
 	  while(CosCM < -1. || CosCM > 1.);	 	  
 	}
@@ -579,6 +947,16 @@ G4double menate_R::NC12_DIFF(G4double NEng)
   return CosCM;
 }
 
+G4double menate_R::NC12_Slope(G4double NEng)
+{
+  G4double FitParam = 0.5;
+  if(NEng >= 70.*MeV)
+    {FitParam = 0.021613*NEng-0.90484;} // Fit to AngDist Data
+
+  G4double DiffSigma = GetCrossSection(NEng,theCarbonXS)/barn;
+  return FitParam*DiffSigma*NEng;
+}
+
 
 //----------------------------------------------------------------------
 //----------------------------------------------------------------------
@@ -631,44 +1009,25 @@ G4double menate_R::GetMeanFreePath(const G4Track& aTrack, G4double previousStepS
   const G4DynamicParticle* projectile = aTrack.GetDynamicParticle();
   G4double theKinEng = projectile->GetKineticEnergy();
 
+  return ComputeMeanFreePath(aTrack.GetMaterial(), theKinEng);
+}
+
+
+G4double menate_R::ComputeMeanFreePath(const G4Material* theMaterial, G4double theKinEng)
+{
   if(theKinEng < 1e-4*MeV)
   {return DBL_MAX;} // Energy too low for this model!
 
   // Now read the medium to get mean free path at this energy!
 
- const G4Material* theMaterial = aTrack.GetMaterial();
-
- // GetVecNbOfAtomsPerVolume() returns (NumberOfAtoms/mm3)! 
- const G4double* N_Per_Volume = theMaterial->GetVecNbOfAtomsPerVolume();
-
- // Get List of Elements in Material, also get number!
- const G4ElementVector* theElementList = theMaterial->GetElementVector();
- G4int NumberOfElements = theMaterial->GetNumberOfElements();
-
  // Only do MeanFreePath calculation if in a material
- // that has Hydrogen or Carbon !
- H_Switch = false;
- C_Switch = false;
-
- for(G4int ne=0;ne<NumberOfElements;ne++)
-   {
-     G4Element* theElement = (*theElementList)[ne];
-
-     //G4cout << "The Element is : " << theElement->GetName() << G4endl;
-     Z = static_cast<int>(theElement->GetZ());
-     A = static_cast<int>(theElement->GetN());  // returns Atomic Weight
-
-     if(Z == 1 && A == 1)
-       { 
-	 H_Switch = true; 
-	 Num_H = N_Per_Volume[ne];
-       }
-     else if(Z == 6 && A == 12)
-       { 
-	 C_Switch = true; 
-	 Num_C = N_Per_Volume[ne];
-       }
-   }
+ // that has Hydrogen or Carbon ! (read once per material)
+ const MaterialParams& theParams = GetMaterialParams(theMaterial);
+ H_Switch = theParams.H_Switch;
+ C_Switch = theParams.C_Switch;
+ Num_H = theParams.Num_H;
+ Num_C = theParams.Num_C;
+ AMass_Material = theParams.AMass;
 
  if(H_Switch == false && C_Switch == false)
    { return DBL_MAX; }
@@ -751,24 +1110,10 @@ G4double menate_R::GetMeanFreePath(const G4Track& aTrack, G4double previousStepS
 
 
 
-//////////////////////////// Comment By Shuya 160525. THIS IS TO CHANGE FOR SCINTILLATION MATERIALS (1/3) /////////////////////////////////
-
-     G4String MaterialName = theMaterial->GetName();
-     if(MaterialName == "NE213")
-//Comment by Shuya: NE213's composition is CH_1.213->12 + 1.213 = 13.213
-       { AMass_Material = 13.213; }
-//NOTE!!! by Shuya 160420. Because I named BC505 as Tnt to avoid complicated name-changing process...
-//Likewise above, BC505 = CH_1.33 = 13.33
-     else if(MaterialName == "Tnt")
-       //{ AMass_Material = 13.33; }
-//by Shuya 160421. Change from BC505 to BC519. C:H ratio is 1.728 (CH_1.728)
-       //{ AMass_Material = 13.728; }
-//by Shuya 160512. Change from BC519 to BC404. C:H ratio is 1.100
-       //{ AMass_Material = 13.100; }
-//by Shuya 160523. Change to EJ309. C:H ratio is 1.250
-       { AMass_Material = 13.250; }
-     else
-       { AMass_Material = theMaterial->GetA(); }
+     // AMass_Material (molar mass per carbon atom) and the density are
+     // taken from the material composition - see GetMaterialParams().
+     // e.g. CH_1.25 (EJ309) gives 12.01 + 1.25*1.01 = 13.27 with the
+     // element masses of TntDetectorConstruction (13.250 in MENATE).
 
      // Get Cross Section Sum at this energy
      ProbDistPerReaction[0] = (GetCrossSection(theKinEng,theHydrogenXS))/barn;
@@ -787,13 +1132,7 @@ G4double menate_R::GetMeanFreePath(const G4Track& aTrack, G4double previousStepS
        {ProbTot += ProbDistPerReaction[k];}
 
 
-//////////////////////////// Comment By Shuya 160525. THIS IS TO CHANGE FOR SCINTILLATION MATERIALS (2/3) /////////////////////////////////
-//for BC505 and BC519
-     //G4double NE213dens = 0.874;
-     //by Shuya 160512. For BC404
-     //G4double NE213dens = 1.023;
-     //by Shuya 160523. For EJ309
-     G4double NE213dens = 0.959;
+     G4double NE213dens = theParams.Density;
 
      G4double NumAvagadro = 0.60221367;   // Num Avagadro*conversion to barns
 //Comments by Shuya 160420. I didn't change this part for BC505 because BC505 density is similar to NE213 anyway. 
@@ -827,10 +1166,120 @@ G4double menate_R::GetMeanFreePath(const G4Track& aTrack, G4double previousStepS
 }
 
 
+G4double menate_R::PostStepGetPhysicalInteractionLength(const G4Track& aTrack, G4double previousStepSize,
+							 G4ForceCondition* condition)
+{
+  if(Force_Interaction == true && Force_Sampled == false && aTrack.GetParentID() == 0)
+    {
+      Force_Sampled = true;
+      Force_Pending = SampleForcedInteraction(aTrack);
+    }
+
+  if(Force_Pending == true)
+    {
+      // Step straight to the sampled point. GetMeanFreePath() still sets
+      // ProbDistPerReaction for the material here, used by ChooseReaction()
+      currentInteractionLength = GetMeanFreePath(aTrack, previousStepSize, condition);
+      G4double Remaining = Force_Length - aTrack.GetTrackLength();
+      return (Remaining > 0.) ? Remaining : 0.;
+    }
+
+  return G4VDiscreteProcess::PostStepGetPhysicalInteractionLength(aTrack, previousStepSize, condition);
+}
+
+
+G4bool menate_R::SampleForcedInteraction(const G4Track& aTrack)
+{
+  // Integrate the optical depth along the (straight) neutron line through
+  // the whole geometry, one volume at a time
+  if(theForceNavigator == 0)
+    { theForceNavigator = new G4Navigator(); }
+  theForceNavigator->SetWorldVolume(G4TransportationManager::GetTransportationManager()->
+				    GetNavigatorForTracking()->GetWorldVolume());
+
+  G4double KinEng = aTrack.GetKineticEnergy();
+  G4ThreeVector Pos = aTrack.GetPosition();
+  G4ThreeVector Dir = aTrack.GetMomentumDirection();
+
+  Force_SegDist.clear();
+  Force_SegLength.clear();
+  Force_SegTau.clear();
+  Force_SegMFP.clear();
+
+  G4double Dist = 0.;
+  G4double Tau = 0.;
+  G4VPhysicalVolume* theVolume = theForceNavigator->LocateGlobalPointAndSetup(Pos, &Dir, false, false);
+
+  for(G4int i=0; i<1000 && theVolume != 0; i++)
+    {
+      G4double Safety = 0.;
+      G4double Step = theForceNavigator->ComputeStep(Pos, Dir, kInfinity, Safety);
+      if(Step >= kInfinity)
+	{ break; }
+
+      G4double MFP = ComputeMeanFreePath(theVolume->GetLogicalVolume()->GetMaterial(), KinEng);
+      if(MFP < DBL_MAX && Step > 0.)
+	{
+	  Force_SegDist.push_back(Dist);
+	  Force_SegLength.push_back(Step);
+	  Force_SegTau.push_back(Tau);
+	  Force_SegMFP.push_back(MFP);
+	  Tau += Step/MFP;
+	}
+
+      Dist += Step;
+      Pos += Step*Dir;
+      theForceNavigator->SetGeometricallyLimitedStep();
+      theVolume = theForceNavigator->LocateGlobalPointAndSetup(Pos, &Dir, true, false);
+    }
+
+  if(Tau <= 0.)
+    { return false; }
+
+  // Interaction probability along the whole line is the weight; the
+  // interaction point follows the exponential truncated to [0,Tau]
+  Force_Weight = -expm1(-Tau);
+  G4double TauInt = -log1p(-G4UniformRand()*Force_Weight);
+
+  size_t iSeg = 0;
+  while(iSeg+1 < Force_SegTau.size() && Force_SegTau[iSeg+1] <= TauInt)
+    { iSeg++; }
+
+  // Keep clear of the segment boundaries so the interaction happens inside
+  G4double Margin = std::min(1e-6*mm, 0.25*Force_SegLength[iSeg]);
+  G4double Distance = (TauInt - Force_SegTau[iSeg])*Force_SegMFP[iSeg];
+  Distance = std::max(Margin, std::min(Distance, Force_SegLength[iSeg] - Margin));
+
+  Force_Length = aTrack.GetTrackLength() + Force_SegDist[iSeg] + Distance;
+  return true;
+}
+
+
 G4VParticleChange* menate_R::PostStepDoIt(const G4Track& aTrack, const G4Step& aStep)
 {
 	TntDataRecordTree* ttnt = TntDataRecordTree::TntPointer;
 
+  // The incoming neutron is always killed and re-emitted as a secondary,
+  // so the (forced interaction) weight reaches the outgoing particles here
+  G4double theWeight = aTrack.GetWeight();
+  if(Force_Pending == true)
+    {
+      Force_Pending = false;
+      theWeight *= Force_Weight;
+      // Only the forcing factor: the event weight already has the
+      // acceptance weight of the primary (senddataAcceptance)
+      if(ttnt)
+	{ ttnt->senddataWeightFactor(Force_Weight); }
+    }
+  aParticleChange.ProposeWeight(theWeight);
+
+  std::chrono::steady_clock::time_point Bench_Start;
+  if(Benchmark == true)
+    { Bench_Start = std::chrono::steady_clock::now(); }
+
+  if(theC12Definition == 0)
+    { ResolveParticleDefinitions(); }
+
   // Now we tell GEANT what to do if MeanFreePath condition is satisfied!
   // Overrides PostStepDoIt function in G4VDiscreteProcess
 
@@ -845,7 +1294,6 @@ G4VParticleChange* menate_R::PostStepDoIt(const G4Track& aTrack, const G4Step& a
   //if((aTrack.GetTrackID())==0)	SetTrackStatus(fStopAndKill);
 
   const G4Material* theMaterial = aTrack.GetMaterial();
-  G4String MaterialName = theMaterial->GetName();
 
   G4double KinEng_Int = projectile->GetKineticEnergy();
   G4ThreeVector MomDir_Int = projectile->GetMomentumDirection();
@@ -875,20 +1323,8 @@ G4VParticleChange* menate_R::PostStepDoIt(const G4Track& aTrack, const G4Step& a
     return pParticleChange;
    } 
 
-//////////////////////////// Comment By Shuya 160525. THIS IS TO CHANGE FOR SCINTILLATION MATERIALS (3/3) /////////////////////////////////
-//
- if(MaterialName == "NE213")
-   { AMass_Material = 13.213; }
-//NOTE!!! by Shuya 160420. Because I named BC505 as Tnt to avoid complicated name-changing process...
-//Likewise above, BC505 = CH_1.33 = 13.33
-     else if(MaterialName == "Tnt")
-       //{ AMass_Material = 13.33; }
-       //by Shuya 160421. Change from BC505 to BC519
-       //{ AMass_Material = 13.728; }
-       //by Shuya 160512. For BC404
-       //{ AMass_Material = 13.100; }
-       //by Shuya 160523. Change to EJ309
-       { AMass_Material = 13.250; }
+ // Atomic mass used by Evaporate_Eng, from the material composition
+ AMass_Material = GetMaterialParams(theMaterial).AMass;
 
   // Define Reaction -
   // Chooses Reaction based on ProbDistPerReaction Vector defined in GetMeanFreePath()
@@ -946,18 +1382,10 @@ if(ReactionName == "N_P_elastic")
 		static int ntimes = 0;
 		
     // Generate a Secondary Neutron
-    G4DynamicParticle* theSecNeutron = new G4DynamicParticle;
-    G4ParticleDefinition* theSecNeutronDefinition = G4Neutron::Neutron();
-    theSecNeutron->SetDefinition(theSecNeutronDefinition);
-    theSecNeutron->SetKineticEnergy(T_N);
-    theSecNeutron->SetMomentumDirection(MomDir_N);
+    G4DynamicParticle* theSecNeutron = new G4DynamicParticle(G4Neutron::Neutron(),MomDir_N,T_N);
 
     // Generate a Secondary Proton
-    G4DynamicParticle* theSecProton = new G4DynamicParticle;
-    G4ParticleDefinition* theSecProtonDefinition = G4Proton::Proton();
-    theSecProton->SetDefinition(theSecProtonDefinition);
-    theSecProton->SetKineticEnergy(T_P);
-    theSecProton->SetMomentumDirection(MomDir_P);
+    G4DynamicParticle* theSecProton = new G4DynamicParticle(G4Proton::Proton(),MomDir_P,T_P);
    
     // Kill the Parent Neutron -----------------------
     aParticleChange.ProposeTrackStatus(fStopAndKill);
@@ -997,10 +1425,10 @@ if(ReactionName == "N_P_elastic")
 				aParticleChange.AddSecondary(theNTrack);
 			}
 	//Produced by beam neutrons, so not track neutrons
-			else	aParticleChange.SetNumberOfSecondaries(1);
+			else	{ aParticleChange.SetNumberOfSecondaries(1); delete theNTrack; }
     }
     //Not track all secondary neutrons.
-    else	aParticleChange.SetNumberOfSecondaries(1);
+    else	{ aParticleChange.SetNumberOfSecondaries(1); delete theNTrack; }
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //by Shuya 160420. To cut off the track after first hit by primary neutron
@@ -1014,7 +1442,8 @@ if(ReactionName == "N_P_elastic")
 			static_cast<const G4TouchableHistory*>(aStep.GetPostStepPoint()->GetTouchable());
 
 		ttnt->senddataMenateR(T_P, thePosition, hist->GetCopyNumber(),
-													GlobalTime, ttnt->GetReactionCode(ReactionName));
+													GlobalTime, ttnt->GetReactionCode(ReactionName),
+													aTrack.GetTrackID(), aParticleChange.GetWeight());
 		
 //by Shuya 160420
 //G4cout << "TESTING!!! " << theNTrack->GetTrackID() << G4endl;
@@ -1068,20 +1497,10 @@ if(ReactionName == "N_P_elastic")
      MomDir_C12 = GenMomDir(MomDir_Int,theta_C12,phi_C12);
     
      // Generate a Secondary Neutron
-     G4DynamicParticle* theSecNeutron = new G4DynamicParticle;
-     G4ParticleDefinition* theSecNeutronDefinition = G4Neutron::Neutron();
-     theSecNeutron->SetDefinition(theSecNeutronDefinition);
-     theSecNeutron->SetKineticEnergy(T_N);
-     theSecNeutron->SetMomentumDirection(MomDir_N);
+     G4DynamicParticle* theSecNeutron = new G4DynamicParticle(G4Neutron::Neutron(),MomDir_N,T_N);
 
      // Generate a Secondary C12
-     G4DynamicParticle* theSecC12 = new G4DynamicParticle;
-     // GetIon() Method works whether particle exists in physicslist or not. 
-     // Arguements are GetIon(Charge,Mass,ExcitationEng)
-     G4ParticleDefinition* theSecC12Definition = G4IonTable::GetIonTable()->GetIon(6,12,0.);
-     theSecC12->SetDefinition(theSecC12Definition);
-     theSecC12->SetKineticEnergy(T_C12el);
-     theSecC12->SetMomentumDirection(MomDir_C12);
+     G4DynamicParticle* theSecC12 = new G4DynamicParticle(theC12Definition,MomDir_C12,T_C12el);
    
      // Kill the Parent Neutron -----------------------
      aParticleChange.ProposeTrackStatus(fStopAndKill);
@@ -1116,10 +1535,10 @@ if(ReactionName == "N_P_elastic")
 				aParticleChange.AddSecondary(theNTrack);
 			}
 	//Produced by beam neutrons, so not track neutrons
-			else	aParticleChange.SetNumberOfSecondaries(1);
+			else	{ aParticleChange.SetNumberOfSecondaries(1); delete theNTrack; }
     }
     //Not track all secondary neutrons.
-   else	aParticleChange.SetNumberOfSecondaries(1);
+   else	{ aParticleChange.SetNumberOfSecondaries(1); delete theNTrack; }
     //by Shuya 160524. To extract only (n,p) reactions, remove all other particles.
     // else	aParticleChange.SetNumberOfSecondaries(0);
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1141,7 +1560,8 @@ if(ReactionName == "N_P_elastic")
 			static_cast<const G4TouchableHistory*>(aStep.GetPostStepPoint()->GetTouchable());
 
 		ttnt->senddataMenateR(T_C12el, thePosition, hist->GetCopyNumber(),
-													GlobalTime, ttnt->GetReactionCode(ReactionName));
+													GlobalTime, ttnt->GetReactionCode(ReactionName),
+													aTrack.GetTrackID(), aParticleChange.GetWeight());
 		
     // G4cout << "Made it to the end ! " << G4endl;
    }
@@ -1188,20 +1608,10 @@ if(ReactionName == "N_P_elastic")
      MomDir_C12 = GenMomDir(MomDir_Int,theta_C12,phi_C12);
 
      // Generate a Secondary Neutron
-     G4DynamicParticle* theSecNeutron = new G4DynamicParticle;
-     G4ParticleDefinition* theSecNeutronDefinition = G4Neutron::Neutron();
-     theSecNeutron->SetDefinition(theSecNeutronDefinition);
-     theSecNeutron->SetKineticEnergy(T_N);
-     theSecNeutron->SetMomentumDirection(MomDir_N);
+     G4DynamicParticle* theSecNeutron = new G4DynamicParticle(G4Neutron::Neutron(),MomDir_N,T_N);
 
      // Generate a Secondary C12*
-     G4DynamicParticle* theSecC12 = new G4DynamicParticle;
-     // GetIon() Method works whether particle exists in physicslist or not. 
-     // Arguements are GetIon(Charge,Mass,ExcitationEng)
-     G4ParticleDefinition* theSecC12Definition = G4IonTable::GetIonTable()->GetIon(6,12,0.);
-     theSecC12->SetDefinition(theSecC12Definition);
-     theSecC12->SetKineticEnergy(T_C12);
-     theSecC12->SetMomentumDirection(MomDir_C12);
+     G4DynamicParticle* theSecC12 = new G4DynamicParticle(theC12Definition,MomDir_C12,T_C12);
 
      // 4.439 MeV Gamma - emitted isotropically from reaction point..
      // -- 24 Apr 2008 - BTR - With 8.5 MeV limit given at start of 
@@ -1231,11 +1641,7 @@ if(ReactionName == "N_P_elastic")
 	     MomDir_Gamma = GenMomDir(MomDir_Int,theta_Gamma,phi_Gamma);
 
 	     // Generate a Secondary Gamma (4.439 MeV)
-	     G4DynamicParticle* theSecGamma = new G4DynamicParticle;
-	     G4ParticleDefinition* theGammaDefinition = G4Gamma::Gamma();
-	     theSecGamma->SetDefinition(theGammaDefinition);
-	     theSecGamma->SetKineticEnergy(T_Gamma);
-	     theSecGamma->SetMomentumDirection(MomDir_Gamma);
+	     G4DynamicParticle* theSecGamma = new G4DynamicParticle(G4Gamma::Gamma(),MomDir_Gamma,T_Gamma);
 
 	     //by Shuya 160509
 	     //aParticleChange.SetNumberOfSecondaries(2+Num_gamma_4439k);
@@ -1281,7 +1687,7 @@ if(ReactionName == "N_P_elastic")
     }
     //NOTE SetNumberOfSecondaries is already dealt above in the case of this reaction
     //Not track all secondary neutrons.
-    //else	aParticleChange.SetNumberOfSecondaries(1);
+    else	delete theNTrack;
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     
      
@@ -1297,7 +1703,8 @@ if(ReactionName == "N_P_elastic")
 			static_cast<const G4TouchableHistory*>(aStep.GetPostStepPoint()->GetTouchable());
 
 		 ttnt->senddataMenateR(T_C12, thePosition, hist->GetCopyNumber(),
-													 GlobalTime, ttnt->GetReactionCode(ReactionName));
+													 GlobalTime, ttnt->GetReactionCode(ReactionName),
+													aTrack.GetTrackID(), aParticleChange.GetWeight());
 
     // G4cout << "Made it to the end ! " << G4endl;
  
@@ -1359,20 +1766,10 @@ if(ReactionName == "N_P_elastic")
      MomDir_Be9 = GenMomDir(MomDir_Int,theta_Be9,phi_Be9);
 
      // Generate a Secondary Alpha
-     G4DynamicParticle* theSecAlpha = new G4DynamicParticle;
-     G4ParticleDefinition* theSecAlphaDefinition = G4Alpha::Alpha();
-     theSecAlpha->SetDefinition(theSecAlphaDefinition);
-     theSecAlpha->SetKineticEnergy(T_Alpha);
-     theSecAlpha->SetMomentumDirection(MomDir_Alpha);
+     G4DynamicParticle* theSecAlpha = new G4DynamicParticle(G4Alpha::Alpha(),MomDir_Alpha,T_Alpha);
 
      // Generate a Secondary Be9
-     G4DynamicParticle* theSecBe9 = new G4DynamicParticle;
-     // GetIon() Method works whether particle exists in physicslist or not. 
-     // Arguements are GetIon(Charge,Mass,ExcitationEng)
-     G4ParticleDefinition* theSecBe9Definition = G4IonTable::GetIonTable()->GetIon(4,9,0.);
-     theSecBe9->SetDefinition(theSecBe9Definition);
-     theSecBe9->SetKineticEnergy(T_Be9);
-     theSecBe9->SetMomentumDirection(MomDir_Be9);
+     G4DynamicParticle* theSecBe9 = new G4DynamicParticle(theBe9Definition,MomDir_Be9,T_Be9);
 
     // Kill the Parent Neutron -----------------------
      aParticleChange.ProposeTrackStatus(fStopAndKill);
@@ -1395,7 +1792,8 @@ if(ReactionName == "N_P_elastic")
 			 static_cast<const G4TouchableHistory*>(aStep.GetPostStepPoint()->GetTouchable());
 
 		 ttnt->senddataMenateR(T_Be9 + T_Alpha, thePosition, hist->GetCopyNumber(),
-													 GlobalTime, ttnt->GetReactionCode(ReactionName));
+													 GlobalTime, ttnt->GetReactionCode(ReactionName),
+													aTrack.GetTrackID(), aParticleChange.GetWeight());
 
 		 
     // G4cout << "Made it to the end ! " << G4endl;
@@ -1450,20 +1848,10 @@ if(ReactionName == "N_P_elastic")
      MomDir_B12 = GenMomDir(MomDir_Int,theta_B12,phi_B12);
 
      // Generate a Secondary Proton
-     G4DynamicParticle* theSecProton = new G4DynamicParticle;
-     G4ParticleDefinition* theSecPDefinition = G4Proton::Proton();
-     theSecProton->SetDefinition(theSecPDefinition);
-     theSecProton->SetKineticEnergy(T_P);
-     theSecProton->SetMomentumDirection(MomDir_P);
+     G4DynamicParticle* theSecProton = new G4DynamicParticle(G4Proton::Proton(),MomDir_P,T_P);
 
      // Generate a Secondary B12
-     G4DynamicParticle* theSecB12 = new G4DynamicParticle;
-     // GetIon() Method works whether particle exists in physicslist or not. 
-     // Arguements are GetIon(Charge,Mass,ExcitationEng)
-     G4ParticleDefinition* theSecB12Definition = G4IonTable::GetIonTable()->GetIon(5,12,0.);
-     theSecB12->SetDefinition(theSecB12Definition);
-     theSecB12->SetKineticEnergy(T_B12);
-     theSecB12->SetMomentumDirection(MomDir_B12);
+     G4DynamicParticle* theSecB12 = new G4DynamicParticle(theB12Definition,MomDir_B12,T_B12);
 
     // Kill the Parent Neutron -----------------------
      aParticleChange.ProposeTrackStatus(fStopAndKill);
@@ -1490,7 +1878,8 @@ if(ReactionName == "N_P_elastic")
 			 static_cast<const G4TouchableHistory*>(aStep.GetPostStepPoint()->GetTouchable());
 
 		 ttnt->senddataMenateR(T_P + T_B12, thePosition, hist->GetCopyNumber(),
-													 GlobalTime, ttnt->GetReactionCode(ReactionName));
+													 GlobalTime, ttnt->GetReactionCode(ReactionName),
+													aTrack.GetTrackID(), aParticleChange.GetWeight());
 
   
     // G4cout << "Made it to the end ! " << G4endl;
@@ -1610,27 +1999,13 @@ if(ReactionName == "N_P_elastic")
      MomDir_B11 = GenMomDir(MomDir_Int,theta_B11,phi_B11);
 
 // Generate a Secondary Neutron
-     G4DynamicParticle* theSecNeutron = new G4DynamicParticle;
-     G4ParticleDefinition* theSecNDefinition = G4Neutron::Neutron();
-     theSecNeutron->SetDefinition(theSecNDefinition);
-     theSecNeutron->SetKineticEnergy(T_N);
-     theSecNeutron->SetMomentumDirection(MomDir_N);
+     G4DynamicParticle* theSecNeutron = new G4DynamicParticle(G4Neutron::Neutron(),MomDir_N,T_N);
 
 // Generate a Secondary Proton
-     G4DynamicParticle* theSecProton = new G4DynamicParticle;
-     G4ParticleDefinition* theSecPDefinition = G4Proton::Proton();
-     theSecProton->SetDefinition(theSecPDefinition);
-     theSecProton->SetKineticEnergy(T_P);
-     theSecProton->SetMomentumDirection(MomDir_P);
+     G4DynamicParticle* theSecProton = new G4DynamicParticle(G4Proton::Proton(),MomDir_P,T_P);
 
      // Generate a Secondary B11
-     G4DynamicParticle* theSecB11 = new G4DynamicParticle;
-     // GetIon() Method works whether particle exists in physicslist or not. 
-     // Arguements are GetIon(Charge,Mass,ExcitationEng)
-     G4ParticleDefinition* theSecB11Definition = G4IonTable::GetIonTable()->GetIon(5,11,0.);
-     theSecB11->SetDefinition(theSecB11Definition);
-     theSecB11->SetKineticEnergy(T_B11);
-     theSecB11->SetMomentumDirection(MomDir_B11);
+     G4DynamicParticle* theSecB11 = new G4DynamicParticle(theB11Definition,MomDir_B11,T_B11);
 
     // Kill the Parent Neutron -----------------------
      aParticleChange.ProposeTrackStatus(fStopAndKill);
@@ -1665,7 +2040,7 @@ if(ReactionName == "N_P_elastic")
 	aParticleChange.AddSecondary(theNTrack);
     }
     //Not track all secondary neutrons.
-    else	aParticleChange.SetNumberOfSecondaries(2);
+    else	{ aParticleChange.SetNumberOfSecondaries(2); delete theNTrack; }
     //by Shuya 160524. To extract only (n,p) reactions, remove all other particles.
     //else	aParticleChange.SetNumberOfSecondaries(0);
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1685,7 +2060,8 @@ if(ReactionName == "N_P_elastic")
 			static_cast<const G4TouchableHistory*>(aStep.GetPostStepPoint()->GetTouchable());
 
 		ttnt->senddataMenateR(T_P + T_B11, thePosition, hist->GetCopyNumber(),
-													GlobalTime, ttnt->GetReactionCode(ReactionName));
+													GlobalTime, ttnt->GetReactionCode(ReactionName),
+													aTrack.GetTrackID(), aParticleChange.GetWeight());
 
 		
     // G4cout << "Made it to the end ! " << G4endl;
@@ -1793,27 +2169,13 @@ if(ReactionName == "N_P_elastic")
      MomDir_C11 = GenMomDir(MomDir_Int,theta_C11,phi_C11);
 
 // Generate a Secondary Neutron1
-     G4DynamicParticle* theSecNeutron1 = new G4DynamicParticle;
-     G4ParticleDefinition* theSecN1Definition = G4Neutron::Neutron();
-     theSecNeutron1->SetDefinition(theSecN1Definition);
-     theSecNeutron1->SetKineticEnergy(T_N1);
-     theSecNeutron1->SetMomentumDirection(MomDir_N1);
+     G4DynamicParticle* theSecNeutron1 = new G4DynamicParticle(G4Neutron::Neutron(),MomDir_N1,T_N1);
 
 // Generate a Secondary Neutron2
-     G4DynamicParticle* theSecNeutron2 = new G4DynamicParticle;
-     G4ParticleDefinition* theSecN2Definition = G4Neutron::Neutron();
-     theSecNeutron2->SetDefinition(theSecN2Definition);
-     theSecNeutron2->SetKineticEnergy(T_N2);
-     theSecNeutron2->SetMomentumDirection(MomDir_N2);
+     G4DynamicParticle* theSecNeutron2 = new G4DynamicParticle(G4Neutron::Neutron(),MomDir_N2,T_N2);
 
      // Generate a Secondary C11
-     G4DynamicParticle* theSecC11 = new G4DynamicParticle;
-     // GetIon() Method works whether particle exists in physicslist or not. 
-     // Arguements are GetIon(Charge,Mass,ExcitationEng)
-     G4ParticleDefinition* theSecC11Definition = G4IonTable::GetIonTable()->GetIon(6,11,0.);
-     theSecC11->SetDefinition(theSecC11Definition);
-     theSecC11->SetKineticEnergy(T_C11);
-     theSecC11->SetMomentumDirection(MomDir_C11);
+     G4DynamicParticle* theSecC11 = new G4DynamicParticle(theC11Definition,MomDir_C11,T_C11);
 
     // Kill the Parent Neutron -----------------------
      aParticleChange.ProposeTrackStatus(fStopAndKill);
@@ -1850,7 +2212,7 @@ if(ReactionName == "N_P_elastic")
 	aParticleChange.AddSecondary(theN2Track);
     }
     //Not track all secondary neutrons.
-    else	aParticleChange.SetNumberOfSecondaries(1);
+    else	{ aParticleChange.SetNumberOfSecondaries(1); delete theN1Track; delete theN2Track; }
     //by Shuya 160524. To extract only (n,p) reactions, remove all other particles.
     //else	aParticleChange.SetNumberOfSecondaries(0);
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1869,7 +2231,8 @@ if(ReactionName == "N_P_elastic")
 			static_cast<const G4TouchableHistory*>(aStep.GetPostStepPoint()->GetTouchable());
 
 		ttnt->senddataMenateR(T_C11, thePosition, hist->GetCopyNumber(),
-													GlobalTime, ttnt->GetReactionCode(ReactionName));
+													GlobalTime, ttnt->GetReactionCode(ReactionName),
+													aTrack.GetTrackID(), aParticleChange.GetWeight());
 
 		
      /*
@@ -2060,32 +2423,16 @@ else if(ReactionName == "N_C12_NN3Alpha")
      MomDir_Alpha3 = GenMomDir(MomDir_Be8Star,theta_Alpha3,phi_Alpha3);
 
 // Generate a Secondary Neutron
-     G4DynamicParticle* theSecNeutron = new G4DynamicParticle;
-     G4ParticleDefinition* theSecNDefinition = G4Neutron::Neutron();
-     theSecNeutron->SetDefinition(theSecNDefinition);
-     theSecNeutron->SetKineticEnergy(T_N);
-     theSecNeutron->SetMomentumDirection(MomDir_N);
+     G4DynamicParticle* theSecNeutron = new G4DynamicParticle(G4Neutron::Neutron(),MomDir_N,T_N);
 
 // Generate a Secondary Alpha1
-     G4DynamicParticle* theSecAlpha1 = new G4DynamicParticle;
-     G4ParticleDefinition* theSecA1Definition = G4Alpha::Alpha();
-     theSecAlpha1->SetDefinition(theSecA1Definition);
-     theSecAlpha1->SetKineticEnergy(T_Alpha1);
-     theSecAlpha1->SetMomentumDirection(MomDir_Alpha1);
+     G4DynamicParticle* theSecAlpha1 = new G4DynamicParticle(G4Alpha::Alpha(),MomDir_Alpha1,T_Alpha1);
 
 // Generate a Secondary Alpha2
-     G4DynamicParticle* theSecAlpha2 = new G4DynamicParticle;
-     G4ParticleDefinition* theSecA2Definition = G4Alpha::Alpha();
-     theSecAlpha2->SetDefinition(theSecA2Definition);
-     theSecAlpha2->SetKineticEnergy(T_Alpha2);
-     theSecAlpha2->SetMomentumDirection(MomDir_Alpha2);
+     G4DynamicParticle* theSecAlpha2 = new G4DynamicParticle(G4Alpha::Alpha(),MomDir_Alpha2,T_Alpha2);
 
 // Generate a Secondary Alpha3
-     G4DynamicParticle* theSecAlpha3 = new G4DynamicParticle;
-     G4ParticleDefinition* theSecA3Definition = G4Alpha::Alpha();
-     theSecAlpha3->SetDefinition(theSecA3Definition);
-     theSecAlpha3->SetKineticEnergy(T_Alpha3);
-     theSecAlpha3->SetMomentumDirection(MomDir_Alpha3);
+     G4DynamicParticle* theSecAlpha3 = new G4DynamicParticle(G4Alpha::Alpha(),MomDir_Alpha3,T_Alpha3);
 
     
     // Kill the Parent Neutron -----------------------
@@ -2124,7 +2471,7 @@ else if(ReactionName == "N_C12_NN3Alpha")
 			aParticleChange.AddSecondary(theNTrack);
     }
     //Not track all secondary neutrons.
-    else	aParticleChange.SetNumberOfSecondaries(3);
+    else	{ aParticleChange.SetNumberOfSecondaries(3); delete theNTrack; }
     //by Shuya 160524. To extract only (n,p) reactions, remove all other particles.
     //else	aParticleChange.SetNumberOfSecondaries(0);
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2145,7 +2492,8 @@ else if(ReactionName == "N_C12_NN3Alpha")
 		const G4TouchableHistory* hist = 
 			static_cast<const G4TouchableHistory*>(aStep.GetPostStepPoint()->GetTouchable());
 		ttnt->senddataMenateR( T_Alpha1 + T_Alpha2 + T_Alpha3, thePosition, hist->GetCopyNumber(),
-													 GlobalTime, ttnt->GetReactionCode(ReactionName));
+													 GlobalTime, ttnt->GetReactionCode(ReactionName),
+													aTrack.GetTrackID(), aParticleChange.GetWeight());
 
 		
      /*
@@ -2159,6 +2507,15 @@ else if(ReactionName == "N_C12_NN3Alpha")
     // G4cout << "Made it to the end ! " << G4endl;
    }
 
+ if(Benchmark == true)
+   {
+     G4int Code = ttnt->GetReactionCode(ReactionName);
+     if(Code >= 1 && Code <= 8)
+       {
+	 Bench_Count[Code-1]++;
+	 Bench_Time[Code-1] += std::chrono::duration<G4double>(std::chrono::steady_clock::now()-Bench_Start).count();
+       }
+   }
 
 return pParticleChange;
 }
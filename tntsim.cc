@@ -61,12 +61,16 @@
 //by Shuya 160406
 #include "TntDataRecordTree.hh"
 #include "TntGlobalParams.hh"
+#include "TntLightMap.hh"
 #include "globals.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4PhysicalConstants.hh"
 
 #include "TntInputFileParser.hh"
 #include "TntError.hh"
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
 #include "g4gen/Rng.hh"
 
 using namespace std;
@@ -88,6 +92,10 @@ G4int NumOfCreatedPhotons = 0;
 G4String macfile = "", inputfile = "";
 
 namespace { inline void run_vis_for_main(const G4String&, G4UImanager*, bool); }
+namespace { inline void run_xs_comparison_for_main(G4RunManager*, TntDataRecordTree*); }
+namespace { inline void run_lightmap_build_for_main(G4RunManager*); }
+namespace { inline void run_energy_sweep_for_main(G4RunManager*, TntDataRecordTree*); }
+namespace { inline void run_geometry_sweep_for_main(G4RunManager*, TntDataRecordTree*); }
 namespace { 	G4int vis = 0; }
 
 int main(int argc, char** argv)
@@ -116,9 +124,32 @@ int main(int argc, char** argv)
 	parser.AddInput("energy",      &TntGlobalParams::SetNeutronEnergy);
 	parser.AddInput("beamtype",    &TntGlobalParams::SetBeamType);
 	parser.AddInput("reacfile",    &TntGlobalParams::SetReacFile);
+	parser.AddInput("primaries_in",  &TntGlobalParams::SetPrimariesIn);
+	parser.AddInput("primaries_out", &TntGlobalParams::SetPrimariesOut);
+	parser.AddInput("neutrons_per_event", &TntGlobalParams::SetNeutronsPerEvent);
+	parser.AddInput("primaries_batch", &TntGlobalParams::SetPrimariesBatch);
 	parser.AddInput("rootfile",    &TntGlobalParams::SetRootFileName);
 	parser.AddInput("resscale",    &TntGlobalParams::SetPhotonResolutionScale);
 	parser.AddInput("ntracking",   &TntGlobalParams::SetMenateR_Tracking);
+	parser.AddInput("menate_sampler",  &TntGlobalParams::SetMenateR_Sampler);
+	parser.AddInput("menate_validate", &TntGlobalParams::SetMenateR_Validate);
+	parser.AddInput("menate_benchmark", &TntGlobalParams::SetMenateR_Benchmark);
+	parser.AddInput("menate_force",    &TntGlobalParams::SetMenateR_Force);
+	parser.AddInput("optical",     &TntGlobalParams::SetOpticalPhysics);
+	parser.AddInput("photon_threshold", &TntGlobalParams::SetPhotonThreshold);
+	parser.AddInput("photon_fraction",  &TntGlobalParams::SetPhotonFraction);
+	parser.AddInput("photon_window",    &TntGlobalParams::SetPhotonWindow);
+	parser.AddInput("photon_maxrefl",   &TntGlobalParams::SetPhotonMaxReflections);
+	parser.AddInput("photon_maxpath",   &TntGlobalParams::SetPhotonMaxPath);
+	parser.AddInput("lightmap",    &TntGlobalParams::SetLightMapFile);
+	parser.AddInput("lightmap_mode", &TntGlobalParams::SetLightMapMode);
+	parser.AddInput("lightmap_dir",  &TntGlobalParams::SetLightMapDir);
+	parser.AddInput("lightmap_grid", &TntGlobalParams::SetLightMapGrid);
+	parser.AddInput("lightmap_photons", &TntGlobalParams::SetLightMapPhotons);
+	parser.AddInput("lightmap_threads", &TntGlobalParams::SetLightMapThreads);
+	parser.AddInput("optical_transport", &TntGlobalParams::SetOpticalTransport);
+	parser.AddInput("optical_packet",    &TntGlobalParams::SetOpticalPacket);
+	parser.AddInput("wls_transport",     &TntGlobalParams::SetWLSTransport);
 	parser.AddInput("array",       &TntGlobalParams::SetNumDetXY);
 	parser.AddInput("nx",          &TntGlobalParams::SetNumPmtX);
 	parser.AddInput("ny",          &TntGlobalParams::SetNumPmtY);
@@ -129,10 +160,59 @@ int main(int argc, char** argv)
 	parser.AddInput("beamz",       &TntGlobalParams::SetSourceZ);
 	parser.AddInput("nphot",       &TntGlobalParams::SetLightOutput);
 	parser.AddInput("qe",          &TntGlobalParams::SetQuantumEfficiency);
+	parser.AddInput("qe_file",     &TntGlobalParams::SetQEFile);
+	parser.AddInput("qe_mode",     &TntGlobalParams::SetQEMode);
 	parser.AddInput("anger",       &TntGlobalParams::SetAngerAnalysis);
+	parser.AddInput("xsfile",      &TntGlobalParams::SetXSFile);
+	parser.AddInput("xscompare",   &TntGlobalParams::AddXSCompare);
+	parser.AddInput("xscompare_energy", &TntGlobalParams::SetXSCompareEnergy);
+	parser.AddInput("xscompare_events", &TntGlobalParams::SetXSCompareEvents);
+	parser.AddInput("energies",     &TntGlobalParams::SetSweepEnergies);
+	parser.AddInput("energy_sweep", &TntGlobalParams::SetEnergySweep);
+	parser.AddInput("sweep_events", &TntGlobalParams::SetSweepEvents);
+	parser.AddInput("geometry",     &TntGlobalParams::AddGeometryConfig);
+	parser.AddInput("geometry_events", &TntGlobalParams::SetGeometryEvents);
+	parser.AddInput("scan_x",      &TntGlobalParams::SetScanX);
+	parser.AddInput("scan_y",      &TntGlobalParams::SetScanY);
+	parser.AddInput("scan_z",      &TntGlobalParams::SetScanZ);
+	parser.AddInput("scan_events", &TntGlobalParams::SetScanEvents);
+	parser.AddInput("scan_split",  &TntGlobalParams::SetScanSplit);
+	parser.AddInput("scan_threshold", &TntGlobalParams::SetScanThreshold);
+	parser.AddInput("scan_summary",   &TntGlobalParams::SetScanSummary);
 	
 	parser.Parse(inputfile);
 	TntGlobalParams::Instance()->SetInputFile(inputfile);
+	if(TntGlobalParams::Instance()->GetLightMapBuild() &&
+		 !TntGlobalParams::Instance()->GetOpticalPhysics()) {
+		TNTERR << "main():: 'lightmap_mode build' tracks optical photons, it cannot be used with 'optical 0'" << G4endl;
+		exit(1);
+	}
+	if(!TntGlobalParams::Instance()->GetPrimariesOut().empty() &&
+		 (TntGlobalParams::Instance()->GetReacFile() == "0" ||
+			!TntGlobalParams::Instance()->GetPrimariesIn().empty())) {
+		TNTERR << "main():: 'primaries_out' records the primaries of a reaction file ('reacfile'), "
+					 << "it cannot be used with the standard generator or 'primaries_in'" << G4endl;
+		exit(1);
+	}
+	if(TntGlobalParams::Instance()->GetUseRayTracing() &&
+		 TntGlobalParams::Instance()->GetUseLightMap()) {
+		TNTERR << "main():: 'optical_transport " << TntGlobalParams::Instance()->GetOpticalTransport()
+					 << "' cannot be used with a light map, both replace photon tracking in the scintillator" << G4endl;
+		exit(1);
+	}
+	if(TntGlobalParams::Instance()->GetAllNeutronsInEvent() &&
+		 TntGlobalParams::Instance()->GetMenateR_Force()) {
+		TNTERR << "main():: 'menate_force' forces every primary neutron, the event weight would only estimate events "
+					 << "where all of them interact; it cannot be used with 'neutrons_per_event all'" << G4endl;
+		exit(1);
+	}
+	if(!TntGlobalParams::Instance()->GetXSCompareLabels().empty() &&
+		 (!TntGlobalParams::Instance()->GetGeometryLabels().empty() ||
+			!TntGlobalParams::Instance()->GetSweepEnergies().empty())) {
+		TNTERR << "main():: 'xscompare' runs its own energy sweep, it cannot be combined with "
+					 << "'geometry', 'energies' or 'energy_sweep'" << G4endl;
+		exit(1);
+	}
 
 	if(FILEOUT_ != "") TntGlobalParams::Instance()->SetRootFileName(FILEOUT_);
 	G4cerr << "Running with RNG seed:: " << g4gen::GetRngSeed() << G4endl;
@@ -155,7 +235,9 @@ int main(int argc, char** argv)
 #ifdef G4MULTITHREADED
   G4MTRunManager * runManager = new G4MTRunManager;
 //by Shuya 160502. If you don't want multi-threading, use this.
-	runManager->SetNumberOfThreads(1);
+	// (the light map calibration does not write the data tree, so it can use more)
+	runManager->SetNumberOfThreads(TntGlobalParams::Instance()->GetLightMapBuild() ?
+																 TntGlobalParams::Instance()->GetLightMapThreads() : 1);
 #else
   G4RunManager * runManager = new G4RunManager;
 #endif
@@ -201,11 +283,25 @@ int main(int argc, char** argv)
  
   // get the pointer to the UI manager and set verbosities
   G4UImanager* UImanager = G4UImanager::GetUIpointer();
-	UImanager->ApplyCommand("/process/optical/defaults/scintillation/setFiniteRiseTime 1");
+	if(TntGlobalParams::Instance()->GetOpticalPhysics()) {
+		UImanager->ApplyCommand("/process/optical/defaults/scintillation/setFiniteRiseTime 1");
+	}
 
 	if(VisFlag == 0)
 	{
-		if(macfile.empty()) {
+		if(TntGlobalParams::Instance()->GetLightMapBuild()) {
+			run_lightmap_build_for_main(runManager);
+		}
+		else if(!TntGlobalParams::Instance()->GetXSCompareLabels().empty()) {
+			run_xs_comparison_for_main(runManager, TntPointer);
+		}
+		else if(!TntGlobalParams::Instance()->GetGeometryLabels().empty()) {
+			run_geometry_sweep_for_main(runManager, TntPointer);
+		}
+		else if(!TntGlobalParams::Instance()->GetSweepEnergies().empty()) {
+			run_energy_sweep_for_main(runManager, TntPointer);
+		}
+		else if(macfile.empty()) {
 			G4UIsession * session = new G4UIterminal;    
 			session->SessionStart();
 			delete session;
@@ -332,3 +428,236 @@ inline void run_vis_for_main(const G4String& VisType, G4UImanager* UImanager, bo
 	}
 }
 }
+
+namespace {
+/// Run the 'xscompare_energy' sweep once per cross-section library
+/// (the 'xsfile' selection, then each 'xscompare' label) and write the
+/// efficiencies side by side to xs_compare_results.dat
+/** Geometry, physics and optical tables are built once; menate_R re-reads
+ *  its cross-section files at the start of the next track after the
+ *  selection changes.
+ */
+inline void run_xs_comparison_for_main(G4RunManager* runManager, TntDataRecordTree* recorder)
+{
+	TntGlobalParams* params = TntGlobalParams::Instance();
+	const std::vector<G4double> energies = params->GetXSCompareEnergies();
+	const G4int nevents = params->GetXSCompareEvents();
+	if(energies.empty() || nevents <= 0) {
+		TNTERR << "run_xs_comparison_for_main:: Need an 'xscompare_energy' range and "
+					 << "a positive 'xscompare_events' value, not running the comparison!" << G4endl;
+		return;
+	}
+	if(params->GetReacFile() != "0") {
+		TNTWAR << "run_xs_comparison_for_main:: The energy sweep only applies to "
+					 << "the standard generator (reacfile 0), the beam comes from " 
+					 << params->GetReacFile() << G4endl;
+	}
+
+	// Resolve every selection before changing any of them
+	std::vector<G4String> labels(1, "default");
+	std::vector<std::map<G4String, G4String> > selections(1, params->GetXSFiles());
+	for(size_t i=0; i< params->GetXSCompareLabels().size(); ++i) {
+		labels.push_back(params->GetXSCompareLabels().at(i));
+		selections.push_back(params->GetXSCompareFiles(labels.back()));
+	}
+
+	runManager->Initialize();
+
+	std::vector<std::vector<G4double> > eff(labels.size(), std::vector<G4double>(energies.size(), 0));
+	std::vector<std::vector<G4double> > err(labels.size(), std::vector<G4double>(energies.size(), 0));
+	for(size_t il=0; il< labels.size(); ++il) {
+		G4cerr << "XS comparison:: library " << labels[il] << G4endl;
+		for(std::map<G4String, G4String>::const_iterator it = selections[il].begin(); it != selections[il].end(); ++it) {
+			G4cerr << "\t" << it->first << " = " << it->second << G4endl;
+		}
+		params->SetXSFiles(selections[il]);
+
+		for(size_t ie=0; ie< energies.size(); ++ie) {
+			params->SetNeutronEnergy(energies[ie]);
+			recorder->ResetNumberAtThisEnergy();
+			runManager->BeamOn(nevents);
+			recorder->GetEfficiency(nevents, eff[il][ie], err[il][ie]);
+			G4cerr << "XS comparison:: " << labels[il] << ", E = " << energies[ie]/MeV 
+						 << " MeV, efficiency = " << eff[il][ie] << G4endl;
+		}
+	}
+	params->SetXSFiles(selections[0]);
+
+	std::ofstream out("xs_compare_results.dat");
+	out << "# Efficiency (fraction of " << nevents << " events above threshold) vs. neutron energy\n";
+	out << "# E(MeV)";
+	for(size_t il=0; il< labels.size(); ++il) { out << "  " << labels[il] << "  err"; }
+	out << "\n";
+	for(size_t ie=0; ie< energies.size(); ++ie) {
+		out << std::setiosflags(std::ios::fixed) << std::setprecision(4) << energies[ie]/MeV;
+		for(size_t il=0; il< labels.size(); ++il) {
+			out << "  " << eff[il][ie] << "  " << err[il][ie];
+		}
+		out << "\n";
+	}
+	G4cerr << "XS comparison:: results written to xs_compare_results.dat" << G4endl;
+}
+}
+
+namespace {
+/// One run of 'sweep_events' events per 'energies' (or 'energy_sweep')
+/// energy, with the efficiencies written to energy_sweep_results.dat
+/** Geometry, physics and cross sections are set up once for the whole
+ *  curve. Events of each run are tagged with their energy in the data tree
+ *  (the initial neutron energy), and each energy also adds its row to
+ *  eff_results_file.dat (TntDataRecordTree::CalculateEff).
+ */
+inline void run_energy_sweep_for_main(G4RunManager* runManager, TntDataRecordTree* recorder)
+{
+	TntGlobalParams* params = TntGlobalParams::Instance();
+	const std::vector<G4double> energies = params->GetSweepEnergies();
+	const G4int nevents = params->GetSweepEvents();
+	if(params->GetReacFile() != "0") {
+		TNTWAR << "run_energy_sweep_for_main:: The energy sweep only applies to "
+					 << "the standard generator (reacfile 0), the beam comes from " 
+					 << params->GetReacFile() << G4endl;
+	}
+
+	runManager->Initialize();
+
+	std::ofstream out("energy_sweep_results.dat");
+	out << "# Efficiency vs. neutron energy, " << nevents << " events per energy\n";
+	out << "# E(MeV)  detected  weighted  efficiency  err\n";
+	for(size_t ie=0; ie< energies.size(); ++ie) {
+		params->SetNeutronEnergy(energies[ie]);
+		recorder->ResetNumberAtThisEnergy();
+		runManager->BeamOn(nevents);
+
+		G4double eff, err;
+		recorder->GetEfficiency(nevents, eff, err);
+		out << std::setiosflags(std::ios::fixed) << std::setprecision(4) << energies[ie]/MeV << "  "
+				<< recorder->GetNumberAtThisEnergy() << "  " << recorder->GetWeightAtThisEnergy() << "  "
+				<< eff << "  " << err << std::endl;
+		recorder->CalculateEff(nevents); // resets the counts
+		G4cerr << "Energy sweep:: E = " << energies[ie]/MeV << " MeV, efficiency = " 
+					 << eff << " +- " << err << G4endl;
+	}
+	G4cerr << "Energy sweep:: results written to energy_sweep_results.dat" << G4endl;
+}
+}
+
+namespace {
+/// One run of 'geometry_events' events per 'geometry' configuration (and
+/// per 'energies' energy, if given), with the efficiencies written to
+/// geometry_sweep_results.dat
+/** Each configuration starts from the input-file geometry and applies its
+ *  macro inside a single geometry update, so the detector is rebuilt once
+ *  per configuration; materials, physics and cross sections are set up once
+ *  for the whole sweep. Events are tagged with the configuration number
+ *  (branch Geometry, 1 for the first configuration), and tInput gets an
+ *  entry with the detector and energy of each run.
+ */
+inline void run_geometry_sweep_for_main(G4RunManager* runManager, TntDataRecordTree* recorder)
+{
+	TntGlobalParams* params = TntGlobalParams::Instance();
+	const std::vector<G4String>& labels = params->GetGeometryLabels();
+	const std::vector<G4String>& macros = params->GetGeometryMacros();
+	const G4int nevents = params->GetGeometryEvents();
+	std::vector<G4double> energies = params->GetSweepEnergies();
+	if(energies.empty()) { energies.push_back(params->GetNeutronEnergy()); }
+	for(size_t ig=0; ig< macros.size(); ++ig) {
+		if(!std::ifstream(macros[ig].c_str()).good()) {
+			TNTERR << "run_geometry_sweep_for_main:: Cannot open the macro of configuration "
+						 << labels[ig] << ": " << macros[ig] << ", not running the sweep!" << G4endl;
+			return;
+		}
+	}
+
+	runManager->Initialize();
+
+	TntDetectorConstruction* detc = (TntDetectorConstruction*)runManager->GetUserDetectorConstruction();
+	G4UImanager* UImanager = G4UImanager::GetUIpointer();
+	const G4double dx = params->GetDetectorX(), dy = params->GetDetectorY(), dz = params->GetDetectorZ();
+
+	std::ofstream out("geometry_sweep_results.dat");
+	out << "# Efficiency vs. detector configuration, " << nevents << " events per run\n";
+	out << "# geometry  label  dx dy dz (cm)  E(MeV)  detected  weighted  efficiency  err\n";
+	for(size_t ig=0; ig< labels.size(); ++ig) {
+		G4cerr << "Geometry sweep:: configuration " << labels[ig] << " (" << macros[ig] << ")" << G4endl;
+		params->SetDetectorX(dx);
+		params->SetDetectorY(dy);
+		params->SetDetectorZ(dz);
+		detc->BeginUpdate();
+		detc->SetDefaults();
+		UImanager->ApplyCommand("/control/execute " + macros[ig]);
+
+		// PMT arrays of the data tree are sized for the input-file PMTs
+		const G4bool skip = detc->GetNX() != params->GetNumPmtX() || detc->GetNY() != params->GetNumPmtY();
+		if(skip) {
+			TNTERR << "run_geometry_sweep_for_main:: Configuration " << labels[ig]
+						 << " changes the number of PMTs (set by 'nx' and 'ny'), skipping it!" << G4endl;
+			detc->SetDefaults();
+		}
+		detc->EndUpdate();
+		if(skip) { continue; }
+		// Source position (TntBeamProfile) and hit offsets follow the detector
+		params->SetDetectorX(detc->GetScintX()/cm);
+		params->SetDetectorY(detc->GetScintY()/cm);
+		params->SetDetectorZ(detc->GetScintZ()/cm);
+
+		for(size_t ie=0; ie< energies.size(); ++ie) {
+			params->SetNeutronEnergy(energies[ie]);
+			recorder->senddataGeometry(ig+1);
+			recorder->ResetNumberAtThisEnergy();
+			runManager->BeamOn(nevents);
+
+			G4double eff, err;
+			recorder->GetEfficiency(nevents, eff, err);
+			out << ig+1 << "  " << labels[ig] << "  " << std::setiosflags(std::ios::fixed) << std::setprecision(4)
+					<< params->GetDetectorX() << " " << params->GetDetectorY() << " " << params->GetDetectorZ() << "  "
+					<< energies[ie]/MeV << "  " << recorder->GetNumberAtThisEnergy() << "  "
+					<< recorder->GetWeightAtThisEnergy() << "  " << eff << "  " << err << std::endl;
+			G4cerr << "Geometry sweep:: " << labels[ig] << ", E = " << energies[ie]/MeV
+						 << " MeV, efficiency = " << eff << " +- " << err << G4endl;
+		}
+	}
+	// Back to the input-file geometry
+	params->SetDetectorX(dx);
+	params->SetDetectorY(dy);
+	params->SetDetectorZ(dz);
+	detc->BeginUpdate();
+	detc->SetDefaults();
+	detc->EndUpdate();
+	G4cerr << "Geometry sweep:: results written to geometry_sweep_results.dat" << G4endl;
+}
+}
+
+namespace {
+/// Calibration run for the light-collection map ('lightmap_mode build'):
+/// one event per voxel, each launching 'lightmap_photons' optical photons,
+/// spread over 'lightmap_threads' worker threads
+/** TntDetectorConstruction sets up the empty map (or keeps the existing
+ *  file if it was already built for this geometry and grid); the map is
+ *  written to TntDetectorConstruction::GetLightMapFileName().
+ */
+inline void run_lightmap_build_for_main(G4RunManager* runManager)
+{
+	runManager->Initialize();
+
+	TntDetectorConstruction* detc = (TntDetectorConstruction*)runManager->GetUserDetectorConstruction();
+	TntLightMap* lightMap = detc->GetLightMap();
+	const G4String fileName = detc->GetLightMapFileName();
+	if(!lightMap) {
+		TNTERR << "run_lightmap_build_for_main:: No light map was set up, not building!" << G4endl;
+		return;
+	}
+	if(lightMap->IsMapped()) {
+		G4cerr << "Light map:: reusing " << fileName << " (" << detc->GetLightMapGeometry() << ")" << G4endl;
+		return;
+	}
+
+	G4cerr << "Light map:: building " << fileName << " for " << detc->GetLightMapGeometry() << G4endl;
+	G4cerr << "Light map:: " << lightMap->GetNumVoxels() << " voxels x "
+				 << TntGlobalParams::Instance()->GetLightMapPhotons() << " photons" << G4endl;
+	runManager->BeamOn(lightMap->GetNumVoxels());
+
+	if(lightMap->Write(fileName)) {
+		G4cerr << "Light map:: written to " << fileName << G4endl;
+	}
+}
+}